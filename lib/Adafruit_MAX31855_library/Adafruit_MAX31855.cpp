@@ -174,6 +174,16 @@ double Adafruit_MAX31855::readFahrenheit(void) {
   return f;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Read the complete 32 bit frame (thermocouple, internal
+    temperature and fault bits) in a single SPI transaction.
+
+    @return The raw 32 bit frame.
+*/
+/**************************************************************************/
+uint32_t Adafruit_MAX31855::readRaw(void) { return spiread32(); }
+
 /**************************************************************************/
 /*!
     @brief  Set the faults to check when reading temperature. If any set
@@ -49,6 +49,7 @@ public:
   double readInternal(void);
   double readCelsius(void);
   double readFahrenheit(void);
+  uint32_t readRaw(void);
   uint8_t readError();
   void setFaultChecks(uint8_t faults);
 
@@ -0,0 +1,109 @@
+/***************************************************************************************
+ * FILE: src/autotune.cpp
+ * LAST MODIFIED: 2026-10-19 21:40 (Europe/Warsaw)
+ * PURPOSE: Autotune PID – eksperyment przekaźnikowy (implementacja)
+ ***************************************************************************************/
+#include "autotune.h"
+#include <math.h>
+
+static const q16_t    AT_OUT_MAX     = 100 * Q16_ONE;
+static const q16_t    AT_BIAS_MIN    = 5 * Q16_ONE;     // bias w 5..(max−5) % – zawsze jest czym grzać/stygnąć
+static const q16_t    AT_OVERSHOOT   = 60 * Q16_ONE;    // zadana + 60 °C → przerwij
+static const uint32_t AT_HALF_MIN_MS = 10000UL;         // przełączenie nie częściej niż co 10 s (szum)
+static const uint32_t AT_HALF_MAX_MS = 3UL * 3600000UL; // pół cyklu > 3 h → nie oscyluje
+static const uint8_t  AT_WARMUP      = 2;               // cykle tylko na ustalenie biasu
+static const uint8_t  AT_MAX_CYCLES  = 15;
+static const double   AT_CONV_TOL    = 0.05;            // dwie kolejne estymaty Ku i Pu w ±5 %
+
+void RelayAutotune::start(uint32_t nowMs, q16_t spQ, q16_t hystQ, q16_t biasQ, q16_t outMaxQ) {
+  _state   = AT_RUNNING;
+  _res     = AutotuneResult();
+  _err     = "";
+  _sp      = spQ;
+  _hyst    = hystQ > 0 ? hystQ : 0;
+  _outMax  = outMaxQ > AT_OUT_MAX ? AT_OUT_MAX : (outMaxQ < 4 * AT_BIAS_MIN ? 4 * AT_BIAS_MIN : outMaxQ);
+  _biasMax = _outMax - AT_BIAS_MIN;
+  _bias    = biasQ < AT_BIAS_MIN ? AT_BIAS_MIN : (biasQ > _biasMax ? _biasMax : biasQ);
+  _d       = (_bias > _outMax / 2) ? _outMax - _bias : _bias;
+  _maxT    = INT32_MIN;
+  _minT    = INT32_MAX;
+  _heating = true;
+  _cycles  = 0;
+  _tSwitchUp = _tSwitchDown = nowMs;
+  _tHigh = _tLow = 0;
+  _lastKu = _lastPu = 0;
+}
+
+void RelayAutotune::cancel() {
+  if (_state == AT_RUNNING) finish(AT_FAILED, "cancelled");
+}
+
+void RelayAutotune::finish(AutotuneState st, const char* err) {
+  _state = st;
+  _err   = err;
+}
+
+bool RelayAutotune::update(uint32_t nowMs, q16_t tempQ, q16_t& duty) {
+  duty = 0;
+  if (_state != AT_RUNNING) return false;
+
+  if (tempQ > _sp + AT_OVERSHOOT) { finish(AT_FAILED, "overshoot"); return false; }
+  if (nowMs - (_heating ? _tSwitchUp : _tSwitchDown) > AT_HALF_MAX_MS) {
+    finish(AT_FAILED, "timeout");
+    return false;
+  }
+
+  if (tempQ > _maxT) _maxT = tempQ;
+  if (tempQ < _minT) _minT = tempQ;
+
+  if (_heating && tempQ > _sp + _hyst && nowMs - _tSwitchUp > AT_HALF_MIN_MS) {
+    // góra przekaźnika → dół; szczyt przyjdzie dopiero po opóźnieniu obiektu
+    _heating     = false;
+    _tSwitchDown = nowMs;
+    _tHigh       = nowMs - _tSwitchUp;
+    _maxT        = tempQ;
+  } else if (!_heating && tempQ < _sp - _hyst && nowMs - _tSwitchDown > AT_HALF_MIN_MS) {
+    // dół → góra: koniec pełnego cyklu
+    _heating   = true;
+    _tLow      = nowMs - _tSwitchDown;
+    _tSwitchUp = nowMs;
+    const q16_t dUsed = _d;
+
+    if (_cycles > 0) {
+      // wyrównanie czasów grzania i stygnięcia przesunięciem biasu
+      int64_t b = _bias + (int64_t)_d * ((int64_t)_tHigh - (int64_t)_tLow) / (int64_t)(_tHigh + _tLow);
+      if (b < AT_BIAS_MIN) b = AT_BIAS_MIN;
+      if (b > _biasMax) b = _biasMax;
+      _bias = (q16_t)b;
+      _d    = (_bias > _outMax / 2) ? _outMax - _bias : _bias;
+    }
+
+    if (_cycles >= AT_WARMUP) {
+      const double a   = q16ToDouble(_maxT - _minT) * 0.5;
+      const double eps = q16ToDouble(_hyst);
+      if (a <= eps) { finish(AT_FAILED, "amplitude"); return false; }
+
+      const double ku = 4.0 * q16ToDouble(dUsed) / (M_PI * sqrt(a * a - eps * eps));
+      const double pu = (_tHigh + _tLow) / 1000.0;
+
+      if (_lastKu > 0 && fabs(ku - _lastKu) <= AT_CONV_TOL * ku && fabs(pu - _lastPu) <= AT_CONV_TOL * pu) {
+        _res.Ku    = 0.5 * (ku + _lastKu);
+        _res.PuSec = 0.5 * (pu + _lastPu);
+        _res.Kp    = 0.6 * _res.Ku;
+        _res.Ki    = 1.2 * _res.Ku / _res.PuSec;
+        _res.Kd    = 0.075 * _res.Ku * _res.PuSec;
+        _cycles++;
+        finish(AT_DONE, "");
+        return false;
+      }
+      _lastKu = ku;
+      _lastPu = pu;
+    }
+
+    if (++_cycles >= AT_MAX_CYCLES) { finish(AT_FAILED, "no convergence"); return false; }
+    _minT = tempQ;
+  }
+
+  duty = _heating ? _bias + _d : _bias - _d;
+  return true;
+}
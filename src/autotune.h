@@ -0,0 +1,63 @@
+/***************************************************************************************
+ * FILE: src/autotune.h
+ * LAST MODIFIED: 2026-10-19 21:40 (Europe/Warsaw)
+ * PURPOSE: Autotune PID – eksperyment przekaźnikowy Åströma–Hägglunda
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+#include "pid_fixed.h"
+
+// Przekaźnik z histerezą wokół zadanej: wyjście bias ± d. Piec grzeje szybciej niż
+// stygnie, więc po każdym cyklu bias jest przesuwany tak, by czasy „grzej” i „stygnij”
+// się wyrównały (oscylacja symetryczna → poprawna funkcja opisująca).
+// Z amplitudy a i okresu oscylacji: Ku = 4d / (π·√(a² − ε²)), Pu = okres,
+// a nastawy wg Zieglera–Nicholsa (klasyczny PID): Kp = 0.6·Ku, Ti = Pu/2, Td = Pu/8.
+// W ticku tylko porównania na Q16.16 – double dopiero na końcu cyklu.
+
+enum AutotuneState : uint8_t {
+  AT_IDLE    = 0,
+  AT_RUNNING = 1,
+  AT_DONE    = 2,   // wynik gotowy do zastosowania
+  AT_FAILED  = 3    // error() mówi dlaczego
+};
+
+struct AutotuneResult {
+  double Ku = 0, PuSec = 0;        // wzmocnienie i okres krytyczny
+  double Kp = 0, Ki = 0, Kd = 0;   // jednostki jak CFG.pid (Ki [1/s], Kd [s])
+};
+
+class RelayAutotune {
+public:
+  // spQ – zadana, hystQ – histereza przekaźnika (ε), obie w °C Q16.16;
+  // biasQ – startowy środek przekaźnika [%], np. wypełnienie utrzymujące zadaną z modelu;
+  // outMaxQ – górna granica wyjścia [%] (limit mocy), przekaźnik mieści się w 0..outMax
+  void start(uint32_t nowMs, q16_t spQ, q16_t hystQ, q16_t biasQ = 50 * Q16_ONE,
+             q16_t outMaxQ = 100 * Q16_ONE);
+  void cancel();
+
+  // wyjście przekaźnika (Q16.16 %); false gdy eksperyment się zakończył (DONE/FAILED)
+  bool update(uint32_t nowMs, q16_t tempQ, q16_t& duty);
+
+  AutotuneState         state()    const { return _state; }
+  uint8_t               cycles()   const { return _cycles; }
+  q16_t                 setpoint() const { return _sp; }
+  const AutotuneResult& result()   const { return _res; }
+  const char*           error()    const { return _err; }
+
+private:
+  void finish(AutotuneState st, const char* err);
+
+  AutotuneState  _state = AT_IDLE;
+  AutotuneResult _res;
+  const char*    _err = "";
+
+  q16_t    _sp = 0, _hyst = 0;
+  q16_t    _bias = 0, _d = 0;           // wyjście = bias ± d
+  q16_t    _outMax = 0;                 // bias ± d ≤ _outMax
+  q16_t    _biasMax = 0;
+  q16_t    _maxT = 0, _minT = 0;        // ekstrema bieżącego cyklu
+  bool     _heating = true;
+  uint8_t  _cycles = 0;
+  uint32_t _tSwitchUp = 0, _tSwitchDown = 0, _tHigh = 0, _tLow = 0;
+  double   _lastKu = 0, _lastPu = 0;    // poprzednia estymata – do testu zbieżności
+};
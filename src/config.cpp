@@ -1,15 +1,23 @@
 /***************************************************************************************
  * FILE: src/config.cpp
- * LAST MODIFIED: 2025-11-10 23:58 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-20 04:30 (Europe/Warsaw)
  * PURPOSE: Definicja globalnego CFG + load/save do LittleFS
  ***************************************************************************************/
 #include "config.h"
 #include <ArduinoJson.h>
 #include <FS.h>
 #include <LittleFS.h>
+#include <math.h>
 
 static const char* CFG_FILE = "/config.json";
 
+// config.json urósł (harmonogram nastaw itd.) – dokument na stercie zamiast 1 KB na stosie
+static const size_t CFG_JSON_CAP = 2560;
+
+// wersja schematu config.json ("ver"); pliki bez klucza to v1 (firmware sprzed migracji)
+//   v2: pid.windowMs naprawdę działa – v1 zapisywał 1000, choć okno było na sztywno 2000 ms
+static const uint8_t CFG_VERSION = 3;
+
 // jedyna definicja
 RuntimeConfig CFG;
 
@@ -28,14 +36,18 @@ void cfgLoadOrDefault(){
   File f = LittleFS.open(CFG_FILE, "r");
   if (!f) return;
 
-  StaticJsonDocument<1024> d;
+  DynamicJsonDocument d(CFG_JSON_CAP);
   DeserializationError err = deserializeJson(d, f);
   f.close();
   if (err) return;
 
+  const uint8_t ver = d["ver"] | 1;
+
   auto p = d["pins"];
   if (p.is<JsonObject>()){
     CFG.pins.SSR      = p["SSR"]      | CFG.pins.SSR;
+    CFG.pins.SSR2     = p["SSR2"]     | CFG.pins.SSR2;
+    CFG.pins.SSR3     = p["SSR3"]     | CFG.pins.SSR3;
     CFG.pins.LED      = p["LED"]      | CFG.pins.LED;
     CFG.pins.BUZZ     = p["BUZZ"]     | CFG.pins.BUZZ;
     CFG.pins.BTN_A    = p["BTN_A"]    | CFG.pins.BTN_A;
@@ -46,6 +58,7 @@ void cfgLoadOrDefault(){
     CFG.pins.SPI_MISO = p["SPI_MISO"] | CFG.pins.SPI_MISO;
     CFG.pins.SPI_SCK  = p["SPI_SCK"]  | CFG.pins.SPI_SCK;
     CFG.pins.SPI_CS   = p["SPI_CS"]   | CFG.pins.SPI_CS;
+    CFG.pins.SPI_CS2  = p["SPI_CS2"]  | CFG.pins.SPI_CS2;
   }
 
   auto q = d["pid"];
@@ -57,6 +70,67 @@ void cfgLoadOrDefault(){
     CFG.pid.outMin    = q["outMin"]    | CFG.pid.outMin;
     CFG.pid.outMax    = q["outMax"]    | CFG.pid.outMax;
     CFG.pid.windowMs  = q["windowMs"]  | CFG.pid.windowMs;
+    if (ver < 2 && CFG.pid.windowMs == 1000) CFG.pid.windowMs = 2000;   // okno, z którym v1 pracował
+    CFG.pid.ssrMod    = q["ssrMod"]    | CFG.pid.ssrMod;
+    CFG.pid.mainsHz   = q["mainsHz"]   | CFG.pid.mainsHz;
+    CFG.pid.spWeight   = q["spWeight"]   | CFG.pid.spWeight;
+    CFG.pid.dFilterN   = q["dFilterN"]   | CFG.pid.dFilterN;
+    CFG.pid.awTrackSec = q["awTrackSec"] | CFG.pid.awTrackSec;
+    CFG.pid.ff         = q["ff"]         | CFG.pid.ff;
+    CFG.pid.adapt      = q["adapt"]      | CFG.pid.adapt;
+    CFG.pid.smith      = q["smith"]      | CFG.pid.smith;
+    CFG.pid.kalman     = q["kalman"]     | CFG.pid.kalman;
+
+    // harmonogram nastaw – wpisy bez temperatury pomijamy, sortowanie przez wstawianie
+    CFG.pid.schedN = 0;
+    for (JsonObject g : q["sched"].as<JsonArray>()){
+      if (CFG.pid.schedN >= GAIN_SCHED_MAX) break;
+      float t = g["t"] | NAN;
+      if (!isfinite(t)) continue;
+      GainPoint gp = { t, g["Kp"] | (float)CFG.pid.Kp, g["Ki"] | (float)CFG.pid.Ki, g["Kd"] | (float)CFG.pid.Kd };
+      uint8_t i = CFG.pid.schedN++;
+      while (i > 0 && CFG.pid.sched[i-1].tempC > t){ CFG.pid.sched[i] = CFG.pid.sched[i-1]; i--; }
+      CFG.pid.sched[i] = gp;
+    }
+  }
+
+  auto h = d["heat"];
+  if (h.is<JsonObject>()){
+    CFG.heat.bankW = h["bankW"] | CFG.heat.bankW;
+    CFG.heat.capW  = h["capW"]  | CFG.heat.capW;
+  }
+
+  auto rs = d["resume"];
+  if (rs.is<JsonObject>()){
+    CFG.resume.en        = rs["en"]     | CFG.resume.en;
+    CFG.resume.maxDropC  = rs["drop"]   | CFG.resume.maxDropC;
+    CFG.resume.maxOffMin = rs["offMin"] | CFG.resume.maxOffMin;
+  }
+
+  auto sf = d["safety"];
+  if (sf.is<JsonObject>()){
+    CFG.safety.boardMaxC = sf["board"]     | CFG.safety.boardMaxC;
+    CFG.safety.weldRiseC = sf["weldC"]     | CFG.safety.weldRiseC;
+    CFG.safety.noRiseMin = sf["noRiseMin"] | CFG.safety.noRiseMin;
+    if (ver < 3 && CFG.safety.noRiseMin == 20) CFG.safety.noRiseMin = 0;   // dawny domyślny – wyłączony
+  }
+
+  auto cc = d["cascade"];
+  if (cc.is<JsonObject>()){
+    CFG.cascade.en       = cc["en"]   | CFG.cascade.en;
+    CFG.cascade.Kp       = cc["Kp"]   | CFG.cascade.Kp;
+    CFG.cascade.Ki       = cc["Ki"]   | CFG.cascade.Ki;
+    CFG.cascade.maxUpC   = cc["up"]   | CFG.cascade.maxUpC;
+    CFG.cascade.maxDownC = cc["down"] | CFG.cascade.maxDownC;
+  }
+
+  auto md = d["model"];
+  if (md.is<JsonObject>()){
+    CFG.model.K       = md["K"]     | CFG.model.K;
+    CFG.model.tauSec  = md["tau"]   | CFG.model.tauSec;
+    CFG.model.deadSec = md["theta"] | CFG.model.deadSec;
+    CFG.model.ambC    = md["amb"]   | CFG.model.ambC;
+    CFG.modelOnline   = md["online"] | CFG.modelOnline;
   }
 
   CFG.sampleSec = d["sampleSec"] | CFG.sampleSec;
@@ -79,16 +153,26 @@ void cfgLoadOrDefault(){
     _safeCopy(CFG.mqttPass, sizeof(CFG.mqttPass), m["pass"] | "");
     _safeCopy(CFG.mqttBaseTopic, sizeof(CFG.mqttBaseTopic), m["base"] | "kiln");
   }
+
+  // migracja jednorazowa – plik od razu w bieżącej wersji
+  if (ver < CFG_VERSION) {
+    Serial.printf("[CFG] config.json v%u -> v%u (windowMs=%lu, noRiseMin=%u)\n",
+                  (unsigned)ver, (unsigned)CFG_VERSION, CFG.pid.windowMs, (unsigned)CFG.safety.noRiseMin);
+    cfgSave();
+  }
 }
 
 void cfgSave(){
   if (!LittleFS.begin()) LittleFS.begin();
 
-  StaticJsonDocument<1024> d;
+  DynamicJsonDocument d(CFG_JSON_CAP);
+  d["ver"] = CFG_VERSION;
 
   {
     JsonObject p = d.createNestedObject("pins");
     p["SSR"]      = CFG.pins.SSR;
+    p["SSR2"]     = CFG.pins.SSR2;
+    p["SSR3"]     = CFG.pins.SSR3;
     p["LED"]      = CFG.pins.LED;
     p["BUZZ"]     = CFG.pins.BUZZ;
     p["BTN_A"]    = CFG.pins.BTN_A;
@@ -99,6 +183,7 @@ void cfgSave(){
     p["SPI_MISO"] = CFG.pins.SPI_MISO;
     p["SPI_SCK"]  = CFG.pins.SPI_SCK;
     p["SPI_CS"]   = CFG.pins.SPI_CS;
+    p["SPI_CS2"]  = CFG.pins.SPI_CS2;
   }
 
   {
@@ -110,6 +195,64 @@ void cfgSave(){
     p["outMin"]    = CFG.pid.outMin;
     p["outMax"]    = CFG.pid.outMax;
     p["windowMs"]  = CFG.pid.windowMs;
+    p["ssrMod"]    = CFG.pid.ssrMod;
+    p["mainsHz"]   = CFG.pid.mainsHz;
+    p["spWeight"]   = CFG.pid.spWeight;
+    p["dFilterN"]   = CFG.pid.dFilterN;
+    p["awTrackSec"] = CFG.pid.awTrackSec;
+    p["ff"]         = CFG.pid.ff;
+    p["adapt"]      = CFG.pid.adapt;
+    p["smith"]      = CFG.pid.smith;
+    p["kalman"]     = CFG.pid.kalman;
+
+    if (CFG.pid.schedN > 0){
+      JsonArray a = p.createNestedArray("sched");
+      for (uint8_t i = 0; i < CFG.pid.schedN; i++){
+        JsonObject g = a.createNestedObject();
+        g["t"]  = CFG.pid.sched[i].tempC;
+        g["Kp"] = CFG.pid.sched[i].Kp;
+        g["Ki"] = CFG.pid.sched[i].Ki;
+        g["Kd"] = CFG.pid.sched[i].Kd;
+      }
+    }
+  }
+
+  {
+    JsonObject h = d.createNestedObject("heat");
+    h["bankW"] = CFG.heat.bankW;
+    h["capW"]  = CFG.heat.capW;
+  }
+
+  {
+    JsonObject rs = d.createNestedObject("resume");
+    rs["en"]     = CFG.resume.en;
+    rs["drop"]   = CFG.resume.maxDropC;
+    rs["offMin"] = CFG.resume.maxOffMin;
+  }
+
+  {
+    JsonObject sf = d.createNestedObject("safety");
+    sf["board"]     = CFG.safety.boardMaxC;
+    sf["weldC"]     = CFG.safety.weldRiseC;
+    sf["noRiseMin"] = CFG.safety.noRiseMin;
+  }
+
+  {
+    JsonObject cc = d.createNestedObject("cascade");
+    cc["en"]   = CFG.cascade.en;
+    cc["Kp"]   = CFG.cascade.Kp;
+    cc["Ki"]   = CFG.cascade.Ki;
+    cc["up"]   = CFG.cascade.maxUpC;
+    cc["down"] = CFG.cascade.maxDownC;
+  }
+
+  {
+    JsonObject md = d.createNestedObject("model");
+    md["K"]     = CFG.model.K;
+    md["tau"]   = CFG.model.tauSec;
+    md["theta"] = CFG.model.deadSec;
+    md["amb"]   = CFG.model.ambC;
+    md["online"] = CFG.modelOnline;
   }
 
   d["sampleSec"] = CFG.sampleSec;
@@ -1,6 +1,6 @@
 /***************************************************************************************
  * FILE: src/config.h
- * LAST MODIFIED: 2025-11-10 23:58 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-20 04:30 (Europe/Warsaw)
  * PURPOSE: Konfiguracja uruchomieniowa i stałe sprzętowe (deklaracje)
  ***************************************************************************************/
 #pragma once
@@ -8,6 +8,11 @@
 
 #define USE_QUICKPID 0
 
+// PID stałoprzecinkowy Q16.16 (pid_fixed.h) – ma pierwszeństwo przed QuickPID/PID_v1
+#ifndef USE_FIXEDPID
+  #define USE_FIXEDPID 1
+#endif
+
 // PT100 / MAX31865
 static const double CFG_RNOMINAL = 100.0;
 static const double CFG_RREF     = 430.0;
@@ -22,6 +27,8 @@ static const double CFG_RREF     = 430.0;
 
 struct PinConfig {
   int SSR   = D0;
+  int SSR2  = -1;   // kolejne sekcje grzałek (większe piece), -1 = brak
+  int SSR3  = -1;
   int LED   = LED_BUILTIN;
   int BUZZ  = D2;
   int BTN_A = -1;
@@ -32,20 +39,91 @@ struct PinConfig {
   int SPI_MISO = D1;
   int SPI_SCK  = D4;
   int SPI_CS   = D8;
+  int SPI_CS2  = -1;   // drugi MAX31855 (termopara przy wyrobie, kaskada) – wspólne SCK/MISO, -1 = brak
+};
+
+// harmonogram nastaw: punkt (temperatura → Kp/Ki/Kd); między punktami interpolacja
+// liniowa, poniżej pierwszego / powyżej ostatniego – nastawy skrajnego punktu
+static const uint8_t GAIN_SCHED_MAX = 6;
+struct GainPoint {
+  float tempC;
+  float Kp, Ki, Kd;
 };
 
 struct PIDConfig {
   double Kp=20, Ki=0.8, Kd=50;
   double setpointC=200;
   double outMin=0, outMax=100;
-  unsigned long windowMs=1000;
+  unsigned long windowMs=2000;   // okno modulacji SSR (WINDOW / BURST)
+  uint8_t ssrMod = 0;           // SsrMod: 0 okno, 1 sigma-delta, 2 burst (ssr_modulator.h)
+  uint8_t mainsHz = 50;         // częstotliwość sieci – kwant sigma-delta / burst
+  // PID v2 (tylko USE_FIXEDPID)
+  double spWeight=1.0;     // waga zadanej w P (0..1)
+  double dFilterN=10;      // filtr D: Tf = Td/N (0 = bez filtru)
+  double awTrackSec=0;     // back-calculation Tt [s] (0 = tylko całkowanie warunkowe)
+  bool ff = false;         // feed-forward z modelu obiektu (CFG.model) dodawany do wyjścia PID
+  bool adapt = false;      // korekty Kp/Ki przy wykrytej oscylacji / wolnej odpowiedzi
+  bool smith = false;      // predyktor Smitha z modelu obiektu (tylko USE_FIXEDPID)
+  bool kalman = true;      // D z nachylenia estymatora temperatury zamiast różnicy pomiaru (USE_FIXEDPID)
+  // gain scheduling (tylko USE_FIXEDPID); schedN = 0 → stałe Kp/Ki/Kd jak wyżej
+  uint8_t   schedN = 0;
+  GainPoint sched[GAIN_SCHED_MAX];   // posortowane rosnąco po tempC
+};
+
+// model obiektu FOPDT: tau·dT/dt + (T − Tamb) = K·u(t − theta), u w % mocy
+struct PlantModel {
+  float K       = 0;    // wzmocnienie statyczne [°C/%], 0 = brak modelu
+  float tauSec  = 0;    // stała czasowa [s]
+  float deadSec = 0;    // opóźnienie [s]
+  float ambC    = 20;   // temperatura otoczenia [°C]
+};
+
+// sekcje grzałek (SSR, SSR2, SSR3) – równe wypełnienie, okna przesunięte w fazie;
+// limit mocy chwilowej: najwyżej capW / bankW sekcji włączonych naraz
+struct HeaterConfig {
+  uint16_t bankW = 0;   // moc jednej sekcji [W], 0 = nieznana (bez limitu)
+  uint16_t capW  = 0;   // limit mocy chwilowej [W], 0 = bez limitu
+};
+
+// wznowienie RUN po zaniku zasilania / resecie (checkpoint w RTC + flash – storage.h);
+// wznawiamy tylko, gdy piec nie zdążył ostygnąć i przerwa była krótka
+struct ResumeConfig {
+  bool     en        = true;
+  uint16_t maxDropC  = 50;   // spadek temperatury od checkpointu [°C]
+  uint16_t maxOffMin = 30;   // przerwa wyliczona z modelu stygnięcia [min] (gdy model jest)
+};
+
+// nadzór bezpieczeństwa (safety.h) – progi poza CFG.maxTempC
+struct SafetyConfig {
+  uint8_t  boardMaxC = 70;   // złącze zimne MAX31855 ≈ wnętrze sterownika [°C]
+  uint8_t  weldRiseC = 10;   // przyrost przy wyłączonych SSR → zgrzany przekaźnik [°C], 0 = bez kontroli
+  // pełna moc bez przyrostu 5 °C → brak grzania [min], 0 = bez kontroli. Domyślnie wyłączone:
+  // przy górnej granicy mocy pieca (wysoko, zużyte grzałki) 5 °C / 20 min bywa normalnym wypałem
+  uint16_t noRiseMin = 0;
+};
+
+// kaskada (tylko USE_FIXEDPID): pętla zewnętrzna na termoparze przy wyrobie (SPI_CS2) wylicza
+// zadaną pętli PID na termoparze przy grzałkach – zadana programu + korekta w [−maxDownC, +maxUpC]
+struct CascadeConfig {
+  bool     en       = false;
+  float    Kp       = 2.0f;     // [°C zadanej wewnętrznej / °C uchybu wyrobu]
+  float    Ki       = 0.002f;   // [1/s] – Ti ≈ 1000 s, rząd opóźnienia wyrobu za powietrzem
+  uint16_t maxUpC   = 60;       // grzałki najwyżej tyle ponad zadaną programu
+  uint16_t maxDownC = 20;       // i najwyżej tyle poniżej (studzenie)
 };
 
-enum Mode : uint8_t { MODE_DYNAMIC=0, MODE_PROFILE=1 };
+// MODE_AUTOTUNE tylko w RAM na czas eksperymentu – potem wraca poprzedni tryb
+enum Mode : uint8_t { MODE_DYNAMIC=0, MODE_PROFILE=1, MODE_AUTOTUNE=2 };
 
 struct RuntimeConfig {
   PinConfig pins;
   PIDConfig pid;
+  HeaterConfig heat;
+  ResumeConfig resume;
+  SafetyConfig safety;
+  CascadeConfig cascade;
+  PlantModel model;
+  bool modelOnline = true;   // FF / autotune / ETA z modelu identyfikowanego w locie, gdy wiarygodny
   Mode mode = MODE_DYNAMIC;
   uint32_t sampleSec = 600;
   double maxTempC = 950.0;
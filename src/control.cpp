@@ -1,17 +1,27 @@
 /***************************************************************************************
  * FILE: src/control.cpp
- * LAST MODIFIED: 2025-11-14 09:20 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-20 05:20 (Europe/Warsaw)
  * PURPOSE: Pomiar MAX31855, PID, SSR + bufor próbek dla wykresu/CSV + profile
  ***************************************************************************************/
 #include "control.h"
 #include "config.h"
+#include "thermocouple.h"
+#include "profile_plan.h"
+#include "storage.h"
+#include "smith_predictor.h"
+#include "ssr_modulator.h"
+#include "safety.h"
+#include "ctrl_watchdog.h"
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <Adafruit_MAX31855.h>
 #include <ArduinoJson.h>
+#include "spsc_queue.h"
 
-#if USE_QUICKPID
+#include "pid_fixed.h"
+#if USE_FIXEDPID
+  // PID stałoprzecinkowy w drzewie – bez zewnętrznej biblioteki
+#elif USE_QUICKPID
   #include <QuickPID.h>
 #else
   #include <PID_v1_bc.h>
@@ -24,13 +34,20 @@
 // ────────────────────────────────────────────────────────────────────────────────
 
 double   KILN_TEMP = 0.0;   // °C
+double   KILN_TEMP_EST = NAN;  // °C
+double   KILN_RATE_CPH = 0.0;  // °C/h
 double   CTRL_TEMP = NAN;   // °C – temperatura sterownika (złącze zimne MAX31855)
+double   WARE_TEMP = NAN;   // °C – termopara przy wyrobie (drugi MAX31855)
+double   CASCADE_SP = NAN;  // °C – zadana pętli przy grzałkach (kaskada)
 double   PID_SET   = 200.0; // °C
 double   PID_OUT   = 0.0;   // 0..100 %
+double   PID_FF    = 0.0;   // 0..100 %
+double   PID_PRED  = 0.0;   // °C
 
 
 bool     RUN_ACTIVE  = false;
 bool     SAFETY_TRIP = false;
+uint8_t  SAFETY_REASON = TRIP_NONE;
 
 bool     HEATER_ON   = false;
 bool     SENSOR_OK   = false;
@@ -39,38 +56,411 @@ uint8_t  PROFILE_ACTIVE = 0;
 uint8_t  PROFILE_LEN    = 0;
 uint32_t RUN_REV        = 0;
 
+int32_t  HEAT_TEQ_MILLI = 0;
+int8_t   HEAT_CONE      = -1;
+
+uint32_t CTRL_TICK_CYCLES     = 0;
+uint32_t CTRL_TICK_CYCLES_MAX = 0;
+uint32_t CTRL_PID_CYCLES      = 0;
+uint32_t CTRL_PID_CYCLES_MAX  = 0;
+uint16_t CTRL_TICK_OVERRUNS   = 0;
+uint16_t CTRL_STARVE_N        = 0;
+uint32_t CTRL_STARVE_MAX_MS   = 0;
+uint32_t THERMO_Q_DROPPED     = 0;
+
 // Profil – kroki
-ProfileStep PROFILE[8];
+ProfileStep PROFILE[PROFILE_MAX_STEPS];
 
 // Czas etapu (sekundy)
 uint32_t PROFILE_ELAPSED_SEC = 0;
 uint32_t PROFILE_REMAIN_SEC  = 0;
+uint8_t  PROFILE_PHASE       = PHASE_IDLE;
+uint32_t PROFILE_ETA_SEC     = 0;   // do końca całego programu (PROFILE_ETA_UNKNOWN – nie da się)
+bool     PROFILE_COOL_LAG    = false;
+
+// skompilowany profil (segmenty rampa/hold na osi czasu planu)
+ProfilePlan PROFILE_PLAN;
 
 // start aktualnego etapu (ms od startu MCU)
 static uint32_t g_profileStepStartMs = 0;
 
+// generator zadanej – bieżący segment planu i moment jego rozpoczęcia (ms od startu MCU);
+// w fazie WAIT g_segStartMs jest przesuwany razem z zegarem – hold jeszcze nie ruszył
+static uint8_t  g_planSeg     = 0;
+static uint32_t g_segStartMs  = 0;
+static uint32_t g_waitStartMs = 0;
+
+// nominalny start rampy pierwszego kroku, gdy nie znamy temperatury pieca (podgląd / ETA)
+static const int32_t PLAN_NOMINAL_START_MILLI = 20000;
+
 // ────────────────────────────────────────────────────────────────────────────────
- // MAX31855 – obiekt tworzony dynamicznie, żeby można było go przepiąć po zmianie pinów
+// MAX31855 – soft-SPI na rejestrach GPIO, czytany z przerwania timer1 (kod w IRAM:
+// biblioteka Adafruit idzie przez digitalWrite()/delayMicroseconds() z flash)
 // ────────────────────────────────────────────────────────────────────────────────
 
-static Adafruit_MAX31855* THERMO = nullptr;
+// pin dla ISR: GPIO0..15 przez GPOS/GPOC/GPI, GPIO16 przez GP16O/GP16I
+struct IsrPin {
+  int8_t   pin  = -1;
+  uint32_t mask = 0;
+};
+
+static IsrPin g_tcSck, g_tcMiso, g_tcCs, g_tcCs2;   // g_tcCs2.pin < 0 → bez drugiego układu
+static volatile bool g_tcReady = false;             // piny ustawione (pinsAndBusesInit)
+
+static const uint32_t TC_HALF_CYC = 40;   // pół okresu SCK: 0.5 µs przy 80 MHz (układ: ≤ 5 MHz)
+
+static IsrPin isrPin(int pin) {
+  IsrPin p;
+  p.pin  = (int8_t)pin;
+  p.mask = (pin >= 0 && pin < 16) ? (1UL << pin) : 0;
+  return p;
+}
+
+static inline __attribute__((always_inline)) void isrPinWrite(const IsrPin& p, bool v) {
+  if (p.pin == 16) { if (v) GP16O |= 1UL; else GP16O &= ~1UL; }
+  else if (v) GPOS = p.mask;
+  else        GPOC = p.mask;
+}
+
+static inline __attribute__((always_inline)) bool isrPinRead(const IsrPin& p) {
+  return (p.pin == 16) ? (GP16I & 1UL) : (GPI & p.mask);
+}
+
+static inline __attribute__((always_inline)) void isrWaitCycles(uint32_t n) {
+  const uint32_t t0 = esp_get_cycle_count();   // rsr ccount – inline, bez wywołania
+  while (esp_get_cycle_count() - t0 < n) {}
+}
+
+// ramka 32-bit jak readRaw(): D31 gotowy po opadnięciu CS, kolejne bity po opadającym SCK
+static uint32_t IRAM_ATTR max31855ReadIsr(const IsrPin& cs) {
+  uint32_t d = 0;
+  isrPinWrite(g_tcSck, false);
+  isrPinWrite(cs, false);
+  isrWaitCycles(TC_HALF_CYC);
+  for (uint8_t i = 0; i < 32; i++) {
+    isrPinWrite(g_tcSck, false);
+    isrWaitCycles(TC_HALF_CYC);
+    d = (d << 1) | (isrPinRead(g_tcMiso) ? 1UL : 0UL);
+    isrPinWrite(g_tcSck, true);
+    isrWaitCycles(TC_HALF_CYC);
+  }
+  isrPinWrite(cs, true);
+  return d;
+}
 
 // ────────────────────────────────────────────────────────────────────────────────
-// PID (QuickPID lub klasyczny PID_v1_bc) – wejście: KILN_TEMP, wyjście: PID_OUT
+// Akwizycja – przerwanie timer1 co 250 ms czyta ramkę MAX31855 do kolejki, controlLoop()
+// ją zjada. Przerwanie nie czeka na loop(): chwila próbkowania nie zależy od długości
+// iteracji, a przy długiej blokadzie (HTTP, flash) ramki czekają w kolejce (~4 s).
 // ────────────────────────────────────────────────────────────────────────────────
 
-#if USE_QUICKPID
+struct ThermoFrame {
+  uint32_t ms;    // millis() w chwili odczytu
+  uint32_t raw;   // surowa ramka 32-bit MAX31855
+  uint32_t raw2;  // ramka drugiego układu (przy wyrobie), 0 = brak układu
+};
+
+static const uint32_t THERMO_PERIOD_MS = CtrlWatchdog::ISR_PERIOD_MS;   // 4 odczyty na sekundę
+static SpscQueue<ThermoFrame, 16> THERMO_Q;     // ~4 s zapasu przy zablokowanej pętli
+
+// znacznik czasu ostatniej przetworzonej próbki (chwila pomiaru, nie obsługi)
+static uint32_t g_lastSampleMs = 0;
+
+static void safetySample(const ThermoFrame& f);   // nadzór bezpieczeństwa – niżej, przy SSR
+
+// z przerwania timer1 – odczyt SPI, wrzutka do kolejki i nadzór bezpieczeństwa; żadnej
+// logiki sterowania – nadzór działa także wtedy, gdy loop() stoi
+static void IRAM_ATTR thermoAcquire() {
+  if (!g_tcReady) return;
+  ThermoFrame f;
+  f.ms   = millis();
+  f.raw  = max31855ReadIsr(g_tcCs);
+  f.raw2 = (g_tcCs2.pin >= 0) ? max31855ReadIsr(g_tcCs2) : 0;
+  THERMO_Q.push(f);
+  safetySample(f);
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// PID (stałoprzecinkowy, QuickPID lub klasyczny PID_v1_bc) – wejście: KILN_TEMP, wyjście: PID_OUT
+// ────────────────────────────────────────────────────────────────────────────────
+
+#if USE_FIXEDPID
+  static FixedPID PIDCTL;   // wejście g_kilnQ16, wyjście g_dutyQ16 (PID_OUT tylko do UI)
+#elif USE_QUICKPID
   static QuickPID PIDCTL(&KILN_TEMP, &PID_OUT, &PID_SET);
 #else
   static PID PIDCTL(&KILN_TEMP, &PID_OUT, &PID_SET, 20.0, 0.8, 50.0, DIRECT);
 #endif
 
+// KILN_TEMP w Q16.16 – liczone prosto z m°C próbki, bez double
+static q16_t g_kilnQ16 = 0;
+
+// wypełnienie SSR w Q16.16 % – tego używa windowDrive(), niezależnie od backendu PID
+static q16_t g_dutyQ16 = 0;
+static q16_t g_dutyMaxQ16 = 100 * Q16_ONE;   // limit mocy (sekcje grzałek) – górna granica PID / FF / autotune
+
+// adaptacja nastaw: korekta Kp/Ki mnożnikiem, ograniczona do ADAPT_MIN..ADAPT_MAX
+// względem nastaw z CFG (albo z harmonogramu) – zła diagnoza nie rozreguluje pieca
+static const float ADAPT_MIN = 0.5f;
+static const float ADAPT_MAX = 1.5f;
+
+float    LOOP_KP_MUL  = 1.0f;
+float    LOOP_KI_MUL  = 1.0f;
+uint16_t LOOP_ADAPT_N = 0;
+
+static LoopMonitor LOOPMON;
+#if USE_FIXEDPID
+static q16_t g_adaptKpQ = Q16_ONE;
+static q16_t g_adaptKiQ = Q16_ONE;
+#endif
+
+const LoopMonitor& loopMonitorInfo() { return LOOPMON; }
+
+#if USE_FIXEDPID
+// harmonogram nastaw (CFG.pid.sched) przeliczony raz do Q16.16 – tick tylko interpoluje
+struct GainQ { q16_t t, kp, ki, kd; };
+static GainQ   g_gainQ[GAIN_SCHED_MAX];
+static uint8_t g_gainN = 0;
+
+static void gainScheduleInit() {
+  g_gainN = CFG.pid.schedN;
+  for (uint8_t i = 0; i < g_gainN; i++) {
+    const GainPoint& g = CFG.pid.sched[i];
+    g_gainQ[i].t = q16FromDouble(g.tempC);
+    PIDCTL.scaleGains(g.Kp, g.Ki, g.Kd, g_gainQ[i].kp, g_gainQ[i].ki, g_gainQ[i].kd);
+  }
+}
+
+static inline q16_t lerpQ(q16_t a, q16_t b, q16_t frac) {
+  return a + (q16_t)(((int64_t)(b - a) * frac) >> 16);
+}
+
+// nastawy dla bieżącej temperatury: odcinek harmonogramu + interpolacja liniowa
+static void gainScheduleApply(q16_t tempQ) {
+  if (g_gainN == 0) return;
+  uint8_t i = 0;
+  while (i + 1 < g_gainN && tempQ >= g_gainQ[i + 1].t) i++;
+
+  const GainQ& a = g_gainQ[i];
+  q16_t kp = a.kp, ki = a.ki, kd = a.kd;   // poza tabelą – skrajny punkt
+  if (i + 1 < g_gainN && tempQ > a.t) {
+    const GainQ& b = g_gainQ[i + 1];
+    const q16_t frac = (q16_t)(((int64_t)(tempQ - a.t) << 16) / (b.t - a.t));
+    kp = lerpQ(a.kp, b.kp, frac);
+    ki = lerpQ(a.ki, b.ki, frac);
+    kd = lerpQ(a.kd, b.kd, frac);
+  }
+  // korekta z nadzoru pętli (1.0 gdy adaptacja nic nie zmieniła)
+  kp = (q16_t)(((int64_t)kp * g_adaptKpQ) >> 16);
+  ki = (q16_t)(((int64_t)ki * g_adaptKiQ) >> 16);
+  PIDCTL.setScaledGains(kp, ki, kd);
+}
+#endif
+
+// identyfikacja modelu w locie – bank RLS, krok co PLANT_TS_MS
+static PlantIdentifier PLANTID;
+
+const PlantIdentifier& plantIdInfo() { return PLANTID; }
+
+const PlantModel& plantModelActive() {
+  return (CFG.modelOnline && PLANTID.valid()) ? PLANTID.model() : CFG.model;
+}
+
+// feed-forward (CFG.model, CFG.pid.ff): u_ff = ((SP − Tamb) + tau·dSP/dt) / K  [%];
+// współczynniki w Q16.16 liczone raz – w ticku tylko mnożenia int64
+static q16_t g_ffQ16    = 0;   // bieżący feed-forward
+static q16_t g_ffInvK   = 0;   // 1/K [%/°C], 0 = wyłączony
+static q16_t g_ffTauK   = 0;   // tau/K [%·s/°C]
+static q16_t g_ffAmbQ16 = 0;
+
+static void feedForwardInit() {
+  const PlantModel& m = plantModelActive();
+  g_ffQ16 = 0;
+  g_ffInvK = (CFG.pid.ff && m.K > 0.0f) ? q16FromDouble(1.0 / m.K) : 0;
+  g_ffTauK = g_ffInvK ? q16FromDouble(m.tauSec / m.K) : 0;
+  g_ffAmbQ16 = q16FromDouble(m.ambC);
+}
+
+// predyktor Smitha (CFG.pid.smith) – PID widzi pomiar przesunięty o theta do przodu
+static SmithPredictor SMITH;
+
+// estymator temperatury i nachylenia (filtr Kalmana, krok = ramka MAX31855)
+static TempEstimator TEMPEST;
+
+static void etaPlanInit();   // ETA programu – niżej, przy profilu
+
+// model się zmienił (konfiguracja / nowa estymata) – przelicz FF, predyktor, estymator i ETA
+static void modelApply() {
+  feedForwardInit();
+  etaPlanInit();
+  TEMPEST.configure(plantModelActive());
+#if USE_FIXEDPID
+  SMITH.configure(CFG.pid.smith ? plantModelActive() : PlantModel());
+#endif
+}
+
+// wejście PID: pomiar + przewidywany przyrost w czasie opóźnienia (0 bez predyktora)
+static inline q16_t pidInputQ() {
+  return g_kilnQ16 + SMITH.correction();
+}
+
+// statyka od zadanej (nie od pomiaru – bez drugiej pętli przez czujnik), dynamika od
+// nachylenia rampy z planu; rateMph w m°C/h
+static q16_t feedForwardCompute(q16_t spQ, int32_t rateMph) {
+  if (!g_ffInvK) return 0;
+  int64_t u = ((int64_t)(spQ - g_ffAmbQ16) * g_ffInvK) >> 16;
+  u += (int64_t)g_ffTauK * rateMph / 3600000LL;        // m°C/h → °C/s
+  if (u < 0) u = 0;
+  if (u > g_dutyMaxQ16) u = g_dutyMaxQ16;
+  return (q16_t)u;
+}
+
+// nachylenie zadanej tylko w trakcie rampy profilu
+static int32_t profileRateMph() {
+  if (CFG.mode != MODE_PROFILE || !RUN_ACTIVE || PROFILE_PHASE != PHASE_RAMP ||
+      PROFILE_COOL_LAG || g_planSeg >= PROFILE_PLAN.len) return 0;
+  return PROFILE_PLAN.seg[g_planSeg].slopeMph;
+}
+
+// benchmark samego kroku PID (ten regulator, który wkompilowano: FixedPID / PID_v1 / QuickPID)
+// – cykle CCOUNT na LX106 (80 MHz), /state: pid_cyc. Liczone tylko dla przeliczonych kroków
+static inline void pidCyclesNote(uint32_t startCycles) {
+  CTRL_PID_CYCLES = ESP.getCycleCount() - startCycles;
+  if (CTRL_PID_CYCLES > CTRL_PID_CYCLES_MAX) CTRL_PID_CYCLES_MAX = CTRL_PID_CYCLES;
+}
+
+// mnożniki → regulator; z harmonogramem mnoży gainScheduleApply() w każdym ticku
+static void adaptApply() {
+#if USE_FIXEDPID
+  g_adaptKpQ = q16FromDouble(LOOP_KP_MUL);
+  g_adaptKiQ = q16FromDouble(LOOP_KI_MUL);
+  if (g_gainN == 0) PIDCTL.setTunings(CFG.pid.Kp * LOOP_KP_MUL, CFG.pid.Ki * LOOP_KI_MUL, CFG.pid.Kd);
+#else
+  PIDCTL.SetTunings(CFG.pid.Kp * LOOP_KP_MUL, CFG.pid.Ki * LOOP_KI_MUL, CFG.pid.Kd);
+#endif
+}
+
+// po kroku PID: ocena pętli, przy werdykcie (i CFG.pid.adapt) jedna ograniczona korekta
+static void loopMonitorStep(uint32_t now, q16_t spQ) {
+  static q16_t lastSpQ = 0;
+  const bool steady    = RUN_ACTIVE && spQ == lastSpQ && profileRateMph() == 0;
+  const bool saturated = g_dutyQ16 <= 0 || g_dutyQ16 >= g_dutyMaxQ16;
+  lastSpQ = spQ;
+  if (!LOOPMON.update(now, spQ - g_kilnQ16, steady, saturated)) return;
+
+  const LoopStats& st = LOOPMON.stats();
+  Serial.printf("[CTRL] Loop %s amp=%.1f period=%lus iae=%.1f\n",
+                loopHealthName(LOOPMON.health()), q16ToDouble(st.ampQ),
+                (unsigned long)(st.periodMs / 1000UL), q16ToDouble(st.iaeQ));
+  if (!CFG.pid.adapt) return;
+
+  // oscylacja: mniej P i I; wolno: więcej I (uchyb ustalony), trochę P
+  float kp = LOOP_KP_MUL, ki = LOOP_KI_MUL;
+  if (LOOPMON.health() == LOOP_OSCILLATING) { kp *= 0.85f; ki *= 0.8f; }
+  else                                      { kp *= 1.05f; ki *= 1.15f; }
+  kp = constrain(kp, ADAPT_MIN, ADAPT_MAX);
+  ki = constrain(ki, ADAPT_MIN, ADAPT_MAX);
+  if (kp == LOOP_KP_MUL && ki == LOOP_KI_MUL) return;   // już na granicy
+
+  LOOP_KP_MUL = kp;
+  LOOP_KI_MUL = ki;
+  LOOP_ADAPT_N++;
+  adaptApply();
+  Serial.printf("[CTRL] Loop adapt #%u Kp x%.2f Ki x%.2f\n", (unsigned)LOOP_ADAPT_N, kp, ki);
+}
+
+// autotune – eksperyment przekaźnikowy zamiast PID (MODE_AUTOTUNE)
+static RelayAutotune AUTOTUNE;
+static Mode          g_atPrevMode = MODE_DYNAMIC;
+
 // ────────────────────────────────────────────────────────────────────────────────
-// Okno czasowe dla SSR (prosty time-proportioning)
+// Kaskada (CFG.cascade) – pętla zewnętrzna na termoparze przy wyrobie wylicza zadaną
+// PIDCTL (termopara przy grzałkach): zadana programu + korekta w [−maxDownC, +maxUpC].
+// Przy grubym wsadzie powietrze przy grzałkach idzie przed wyrobem, ale najwyżej o maxUpC –
+// szybsze rampy bez przegrzewania grzałek. Nadzór (OVERTEMP) dalej na termoparze przy
+// grzałkach, więc zadana wewnętrzna kończy się CASCADE_MARGIN_C pod CFG.maxTempC.
+// Bez ważnego pomiaru wyrobu – zwykła pętla na PID_SET, przejście bez uderzenia.
 // ────────────────────────────────────────────────────────────────────────────────
 
-static unsigned long WINDOW_START = 0;
-static const unsigned long WINDOW_MS = 2000UL; // 2 s – możesz zmienić jeśli chcesz
+static const uint32_t CASCADE_SAMPLE_MS = 1000;   // pętla zewnętrzna – wyrób i tak jest wolny
+static const double   CASCADE_MARGIN_C  = 10.0;
+
+static FixedPID CASCADE_PID;          // wejście: wyrób, wyjście: korekta zadanej [°C Q16.16]
+static q16_t    g_cascadeDeltaQ16 = 0;
+static bool     g_cascadeOn       = false;
+
+static void cascadeApplyConfig() {
+  CASCADE_PID.setTunings(CFG.cascade.Kp, CFG.cascade.Ki, 0.0);
+  CASCADE_PID.setSampleTime(CASCADE_SAMPLE_MS);
+  CASCADE_PID.setOutputLimits(-(q16_t)CFG.cascade.maxDownC * Q16_ONE, (q16_t)CFG.cascade.maxUpC * Q16_ONE);
+}
+
+// temperatura, której dotyczy program (pasmo holdu, rampa studzenia, start rampy):
+// wyrób, gdy kaskada ma pomiar, inaczej termopara przy grzałkach
+static double programTempC() {
+  return (CFG.cascade.en && isfinite(WARE_TEMP)) ? WARE_TEMP : KILN_TEMP;
+}
+
+// co tick: zadana pętli wewnętrznej [°C], NAN = kaskada nieaktywna (PIDCTL na PID_SET)
+static double cascadeSetpoint(uint32_t now) {
+#if USE_FIXEDPID
+  const bool want = CFG.cascade.en && RUN_ACTIVE && CFG.mode != MODE_AUTOTUNE && isfinite(WARE_TEMP);
+#else
+  const bool want = false;   // QuickPID / PID_v1 trzymają wskaźnik na PID_SET
+#endif
+  if (want != g_cascadeOn) {
+    g_cascadeOn = want;
+    if (want) {
+      // start od bieżącej temperatury przy grzałkach – zadana wewnętrzna bez skoku
+      const q16_t lo = -(q16_t)CFG.cascade.maxDownC * Q16_ONE;
+      const q16_t hi =  (q16_t)CFG.cascade.maxUpC * Q16_ONE;
+      const q16_t d  = g_kilnQ16 - q16FromDouble(PID_SET);
+      g_cascadeDeltaQ16 = d < lo ? lo : (d > hi ? hi : d);
+      CASCADE_PID.initialize(q16FromDouble(WARE_TEMP), q16FromDouble(PID_SET), g_cascadeDeltaQ16);
+      Serial.printf("[CTRL] Cascade on: ware %.1f, elements %.1f\n", WARE_TEMP, KILN_TEMP);
+    } else if (RUN_ACTIVE && CFG.cascade.en) {
+      Serial.println(F("[CTRL] Cascade off: ware thermocouple lost – single loop"));
+    }
+  }
+  if (!want) return NAN;
+
+  CASCADE_PID.compute(now, q16FromDouble(WARE_TEMP), q16FromDouble(PID_SET), g_cascadeDeltaQ16);
+  const double sp  = PID_SET + q16ToDouble(g_cascadeDeltaQ16);
+  const double top = CFG.maxTempC - CASCADE_MARGIN_C;
+  return sp < top ? sp : top;
+}
+
+// bezuderzeniowe przejęcie PID: start RUN, skok kroku profilu, zmiana trybu.
+// Całka nie zostaje w stanie sprzed przełączenia (to dawało duże przeregulowania).
+// output = całkowite wypełnienie (PID + feed-forward)
+static void pidBumpless(q16_t output) {
+#if USE_FIXEDPID
+  PIDCTL.initialize(pidInputQ(), q16FromDouble(isfinite(CASCADE_SP) ? CASCADE_SP : PID_SET), output - g_ffQ16);
+#elif USE_QUICKPID
+  PID_OUT = q16ToDouble(output - g_ffQ16);
+  PIDCTL.Initialize();
+#else
+  PID_OUT = q16ToDouble(output - g_ffQ16);
+  PIDCTL.SetMode(MANUAL);      // MANUAL → AUTOMATIC wywołuje PID::Initialize()
+  PIDCTL.SetMode(AUTOMATIC);
+#endif
+  g_dutyQ16 = output;
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Modulacja SSR (CFG.pid.ssrMod: okno / sigma-delta / burst) – ssr_modulator.h
+// ────────────────────────────────────────────────────────────────────────────────
+
+// Sekcje grzałek (CFG.pins.SSR / SSR2 / SSR3) – jeden modulator dla wszystkich, sekcje
+// włączane na zmianę; limit mocy chwilowej CFG.heat (capW / bankW sekcji naraz) to
+// obcięcie wypełnienia do maxOn/N (g_dutyMaxQ16) – modulator nie przekroczy ⌈N·d⌉.
+static SsrModulator SSRMOD;
+static int      g_bankPin[SSR_MOD_BANKS_MAX] = { -1, -1, -1 };
+static uint8_t  g_ssrMask = 0;   // bit i = sekcja i włączona
+uint32_t SSR_SWITCHES     = 0;   // przełączenia SSR od startu, suma po sekcjach (zużycie / EMI)
+uint8_t  SSR_BANKS        = 1;
+uint8_t  SSR_BANKS_ON     = 0;
+uint8_t  SSR_BANKS_MAX_ON = 1;
 
 
 // ────────────────────────────────────────────────────────────────────────────────
@@ -109,9 +499,12 @@ static void buzzLoop(unsigned long nowMs) {
 
 struct Sample {
   uint32_t rev;   // RUN_REV przy próbkowaniu
+  uint32_t ms;    // chwila pomiaru temperatury (millis() z timera akwizycji)
   float    temp;  // KILN_TEMP
   float    out;   // PID_OUT
   uint16_t heat;  // HEATER_ON (0/1)
+  uint16_t teq;   // praca cieplna RUN – temperatura ekwiwalentna [°C], 0 = jeszcze brak
+  uint32_t wh;    // energia RUN do tej chwili [Wh]
 };
 
 static const uint16_t S_CAP = 240;   // ~4 min przy kroku 1 s
@@ -122,38 +515,307 @@ static uint16_t S_LEN = 0;
 // Pomocnicze
 // ────────────────────────────────────────────────────────────────────────────────
 
-static inline void ssrWrite(bool on) {
-  HEATER_ON = on;
-  if (CFG.pins.SSR >= 0) {
-    digitalWrite(CFG.pins.SSR, on ? HIGH : LOW);
+// czas włączenia SSR do estymatora – liczony na zboczach, odbierany co ramkę pomiaru
+// (w ms × liczba włączonych sekcji)
+static uint32_t g_ssrOnMs   = 0;
+static uint32_t g_ssrEdgeMs = 0;
+static uint32_t g_ssrMarkMs = 0;
+
+// energia grzałek od startu [W·ms] – faktyczny czas włączenia sekcji × CFG.heat.bankW
+static uint64_t g_energyWms = 0;
+
+// odcinek od poprzedniego zbocza / odbioru → czas włączenia i energia (stan sprzed zmiany)
+static inline void ssrAccount(uint32_t now) {
+  const uint32_t dt = now - g_ssrEdgeMs;
+  g_ssrEdgeMs = now;
+  if (!SSR_BANKS_ON) return;
+  g_ssrOnMs   += dt * SSR_BANKS_ON;
+  g_energyWms += (uint64_t)(dt * SSR_BANKS_ON) * CFG.heat.bankW;
+}
+
+static inline void ssrWrite(uint8_t mask) {
+  if (mask != g_ssrMask) {
+    ssrAccount(millis());
+    SSR_SWITCHES += __builtin_popcount(mask ^ g_ssrMask);
+    g_ssrMask     = mask;
+  }
+  SSR_BANKS_ON = (uint8_t)__builtin_popcount(mask);
+  HEATER_ON    = mask != 0;
+  for (uint8_t i = 0; i < SSR_BANKS; i++) {
+    if (g_bankPin[i] >= 0) digitalWrite(g_bankPin[i], (mask >> i) & 1u ? HIGH : LOW);
   }
   if (CFG.pins.LED >= 0) {
     // jeśli używasz wbudowanej diody z odwrotną logiką, możesz to tu odwrócić
-    digitalWrite(CFG.pins.LED, on ? LOW : HIGH);
+    digitalWrite(CFG.pins.LED, HEATER_ON ? LOW : HIGH);
+  }
+}
+
+// udział mocy grzałek od poprzedniego odbioru (Q16.16, 0..1 – średnio po sekcjach)
+static q16_t ssrOnFracTake(uint32_t now) {
+  ssrAccount(now);
+  const uint32_t onMs = g_ssrOnMs;
+  const uint64_t span = (uint64_t)(now - g_ssrMarkMs) * SSR_BANKS;
+  g_ssrOnMs   = 0;
+  g_ssrMarkMs = now;
+  if (!span) return 0;
+  return (onMs >= span) ? Q16_ONE : (q16_t)(((uint64_t)onMs << 16) / span);
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Timer1 – przerwanie co 250 ms: akwizycja z nadzorem (thermoAcquire) i watchdog sterowania.
+// Działa, gdy loop() stoi w długim HTTP / zapisie flash (WDT SDK jest wtedy karmiony przez
+// yield(), więc sam go nie pilnuje). Watchdog karmi tylko tick controlLoop() zakończony
+// w terminie; po 1 s bez karmienia ISR gasi piny sekcji, niezależnie od pętli. Seria
+// RESTART_MISSES ticków ponad termin → grzałki OFF i ESP.restart() (RUN wraca z checkpointu).
+// Timer1 jest zajęty na stałe: tone(), analogWrite() (PWM) i Servo z rdzenia go używają –
+// nie wolno ich wołać (buzzer i LED są sterowane digitalWrite()).
+// ────────────────────────────────────────────────────────────────────────────────
+
+static CtrlWatchdog      WDOG;
+static volatile uint32_t g_wdGpoMask = 0;       // sekcje na GPIO0..15 (rejestr GPOC)
+static volatile bool     g_wdGpio16  = false;   // sekcja na GPIO16 (osobny rejestr)
+static volatile bool     g_wdRunning = false;   // watchdog uzbrojony (pierwszy tick)
+static volatile uint8_t  g_isrTrip   = TRIP_NONE;   // zadziałanie nadzoru z ISR – do odbioru w controlLoop()
+static bool g_timerOn = false;
+static bool g_wdOff   = false;                  // zagłodzenie już zapisane – do ticku w terminie
+
+// rejestry GPIO wprost – z ISR, bez digitalWrite() (może trafić w zapis flash)
+static inline __attribute__((always_inline)) void bankPinsOffIsr() {
+  if (g_wdGpoMask) GPOC = g_wdGpoMask;
+  if (g_wdGpio16)  GP16O &= ~1UL;
+}
+
+static void IRAM_ATTR ctrlTimerIsr() {
+  thermoAcquire();
+  if (!g_wdRunning || !WDOG.isrTick()) return;
+  bankPinsOffIsr();
+}
+
+// piny sekcji → maski dla ISR (heaterBanksInit)
+static void ctrlWatchdogPins() {
+  uint32_t m = 0;
+  bool p16 = false;
+  for (uint8_t i = 0; i < SSR_BANKS; i++) {
+    if (g_bankPin[i] == 16) p16 = true;
+    else if (g_bankPin[i] >= 0 && g_bankPin[i] < 16) m |= 1UL << g_bankPin[i];
   }
+  g_wdGpoMask = m;
+  g_wdGpio16  = p16;
+}
+
+// przerwanie rusza z pinami MAX31855 (pinsAndBusesInit) – akwizycja jeszcze w setup()
+static void ctrlTimerBegin() {
+  if (g_timerOn) return;
+  g_timerOn = true;
+  timer1_attachInterrupt(ctrlTimerIsr);
+  timer1_enable(TIM_DIV256, TIM_EDGE, TIM_LOOP);
+  timer1_write(CtrlWatchdog::ISR_PERIOD_MS * 3125 / 10);   // APB 80 MHz / 256 = 312.5 tyknięć na ms
 }
 
-static inline double readTempC() {
-  if (!THERMO) return NAN;
-  double v = THERMO->readCelsius();
-  if (!isfinite(v)) return NAN;
-  return v;
+// uzbrojenie przy pierwszym ticku – setup() (FS, WiFi) nie liczy się jako zagłodzenie
+static void ctrlWatchdogBegin(uint32_t nowMs) {
+  WDOG.begin(nowMs);
+  g_wdRunning = true;
 }
 
-// pojedynczy krok algorytmu okna SSR
+// tick po zagłodzeniu: ISR zgasił piny – licznik i energia do chwili wyłączenia; windowDrive()
+// tego ticku ustawi sekcje od nowa, ale dopóki ticki nie wrócą w termin, ISR gasi je dalej.
+// Licznika przerwań tu nie ruszamy – zeruje go tylko tick w terminie (ctrlWatchdogFeed)
+static void ctrlWatchdogRecover(uint32_t nowMs) {
+  if (!WDOG.takeStarved()) return;
+
+  const uint32_t offMs = WDOG.offMs();
+  ssrAccount((int32_t)(offMs - g_ssrEdgeMs) > 0 ? offMs : g_ssrEdgeMs);
+  SSR_SWITCHES += __builtin_popcount(g_ssrMask);
+  g_ssrMask    = 0;
+  SSR_BANKS_ON = 0;
+  HEATER_ON    = false;
+
+  const uint32_t gap = nowMs - WDOG.fedMs();
+  if (gap > CTRL_STARVE_MAX_MS) CTRL_STARVE_MAX_MS = gap;
+  if (g_wdOff) return;   // to samo zdarzenie – kolejne ticki ponad termin
+  g_wdOff = true;
+  CTRL_STARVE_N++;
+  Serial.printf("[CTRL] Control tick starved %lu ms – heater forced off (events=%u)\n",
+                (unsigned long)gap, (unsigned)CTRL_STARVE_N);
+}
+
+// koniec ticku: karmienie tylko w terminie
+static void ctrlWatchdogFeed(uint32_t startMs) {
+  if (WDOG.feed(startMs, millis())) { g_wdOff = false; return; }
+  CTRL_TICK_OVERRUNS++;
+  if (!WDOG.restartDue()) return;
+
+  // pętla trwale za wolna – grzałki OFF i restart; checkpoint w RTC (≤ 5 s) wznowi RUN
+  ssrWrite(0);
+  Serial.printf("[CTRL] %u control ticks over deadline – heater off, restarting\n",
+                (unsigned)CtrlWatchdog::RESTART_MISSES);
+  Serial.flush();
+  ESP.restart();
+}
+
+// sekcje z pinów + limit mocy; przy starcie, zmianie pinów i konfiguracji
+static void heaterBanksInit() {
+  ssrWrite(0);   // stare piny w stan niski, zanim lista się zmieni
+  const int pins[SSR_MOD_BANKS_MAX] = { CFG.pins.SSR, CFG.pins.SSR2, CFG.pins.SSR3 };
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < SSR_MOD_BANKS_MAX; i++) {
+    if (pins[i] >= 0) g_bankPin[n++] = pins[i];
+  }
+  if (n == 0) g_bankPin[n++] = -1;   // bez pinu: jedna wirtualna sekcja (UI / model jak dotąd)
+  for (uint8_t i = n; i < SSR_MOD_BANKS_MAX; i++) g_bankPin[i] = -1;
+  SSR_BANKS = n;
+
+  uint8_t maxOn = n;
+  if (CFG.heat.bankW > 0 && CFG.heat.capW > 0) {
+    const uint16_t m = CFG.heat.capW / CFG.heat.bankW;
+    maxOn = (m < 1) ? 1 : (m < n ? (uint8_t)m : n);
+  }
+  SSR_BANKS_MAX_ON = maxOn;
+  g_dutyMaxQ16     = (q16_t)(100L * Q16_ONE * maxOn / n);
+
+  SSRMOD.configure(CFG.pid.ssrMod, CFG.pid.windowMs, CFG.pid.mainsHz, n);
+  ctrlWatchdogPins();
+  Serial.printf("[CTRL] Heater banks=%u max_on=%u duty_max=%.0f%%\n",
+                (unsigned)n, (unsigned)maxOn, q16ToDouble(g_dutyMaxQ16));
+}
+
+// pojedynczy krok modulacji SSR (modulator liczy dalej także przy zatrzymaniu – bez skoku po starcie)
 static void windowDrive(unsigned long nowMs) {
-  if (nowMs - WINDOW_START >= WINDOW_MS) {
-    WINDOW_START = nowMs;
+  const uint8_t mask = SSRMOD.step(nowMs, g_dutyQ16 < g_dutyMaxQ16 ? g_dutyQ16 : g_dutyMaxQ16);
+  ssrWrite((RUN_ACTIVE && !SAFETY_TRIP && g_isrTrip == TRIP_NONE) ? mask : 0);
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Nadzór bezpieczeństwa (safety.h) – każda ramka prosto z thermoAcquire() w przerwaniu
+// timer1, obok ścieżki PID i niezależnie od loop(). Zadziałanie od razu gasi piny sekcji
+// (i dalej co ramkę); controlLoop() odbiera je z g_isrTrip, zatrzymuje RUN i loguje.
+// ────────────────────────────────────────────────────────────────────────────────
+
+static SafetySupervisor SAFETY;                   // stan zmienia tylko ISR (poza reset/configure)
+static bool g_tripHandled = false;                // controlLoop() obsłużył bieżące zadziałanie
+
+// progi z CFG – przy starcie i po zmianie konfiguracji (pidApplyConfig)
+static void safetyApplyConfig() {
+  SafetyLimits lim;
+  lim.maxMilli      = (int32_t)lround(CFG.maxTempC * 1000.0);
+  lim.boardMaxMilli = (int32_t)CFG.safety.boardMaxC * 1000;
+  lim.weldRiseMilli = (int32_t)CFG.safety.weldRiseC * 1000;
+  lim.noRiseMs      = (uint32_t)CFG.safety.noRiseMin * 60000UL;
+  noInterrupts();
+  SAFETY.configure(lim);
+  interrupts();
+}
+
+// z ISR – tcDecodeFrame / tcLinearizeCounts / SafetySupervisor::sample są w IRAM
+static void IRAM_ATTR safetySample(const ThermoFrame& f) {
+  if (g_isrTrip != TRIP_NONE) { bankPinsOffIsr(); return; }   // zatrzaśnięty – do potwierdzenia
+  int16_t tc, cj;
+  const bool    ok   = tcDecodeFrame(f.raw, tc, cj);
+  const int32_t kiln = ok ? tcLinearizeCounts(tc, cj) : 0;
+  // „pełna moc” = wyjście w limicie mocy (PID nasycony), nie chwilowy stan SSR w oknie
+  const bool    full = RUN_ACTIVE && !SAFETY_TRIP && g_dutyQ16 >= g_dutyMaxQ16;
+  const SafetyTrip t = SAFETY.sample(f.ms, ok, kiln, (int32_t)cj * 125 / 2, g_ssrMask != 0, full);
+  if (t == TRIP_NONE) return;
+
+  g_isrTrip = t;
+  bankPinsOffIsr();   // windowDrive() w loop() dopisze resztę (licznik, LED)
+}
+
+// odbiór zadziałania z ISR – na początku ticku, przed windowDrive()
+static void safetyPoll() {
+  const uint8_t t = g_isrTrip;
+  if (t == TRIP_NONE || SAFETY_TRIP) return;
+  SAFETY_TRIP   = true;
+  SAFETY_REASON = t;
+}
+
+void safetyReset() {
+  if (SAFETY_TRIP) Serial.printf("[CTRL] Safety trip acknowledged: %s\n", safetyTripName(SAFETY_REASON));
+  noInterrupts();
+  SAFETY.reset(millis());
+  g_isrTrip = TRIP_NONE;
+  interrupts();
+  SAFETY_TRIP   = false;
+  SAFETY_REASON = TRIP_NONE;
+  g_tripHandled = false;
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Energia – kWh na RUN i na krok profilu (g_energyWms z ssrAccount())
+// ────────────────────────────────────────────────────────────────────────────────
+// Tick nic tu nie liczy: licznik rośnie tylko na zboczach SSR, RUN i krok to znaczniki
+// licznika. Krok dostaje całe Wh, reszta przechodzi na następny – suma kroków = RUN.
+
+static const uint32_t WMS_PER_WH = 3600000UL;
+
+static uint64_t g_runMarkWms  = 0;
+static uint64_t g_stepMarkWms = 0;
+static uint32_t g_stepWh[PROFILE_MAX_STEPS];   // ostatni / bieżący RUN
+static uint32_t g_runStartMs  = 0;
+static uint32_t g_runEndMs    = 0;
+
+static uint64_t energyNowWms() {
+  ssrAccount(millis());
+  return g_energyWms;
+}
+
+// energia od ostatniego znacznika → bieżący krok profilu (credit = false: tylko znacznik,
+// np. przy wczytaniu profilu po RUN w innym trybie)
+static void energyStepClose(bool credit) {
+  const uint64_t e  = energyNowWms();
+  if (!credit) { g_stepMarkWms = e; return; }
+  const uint32_t wh = (uint32_t)((e - g_stepMarkWms) / WMS_PER_WH);
+  if (PROFILE_ACTIVE < PROFILE_MAX_STEPS) g_stepWh[PROFILE_ACTIVE] += wh;
+  g_stepMarkWms += (uint64_t)wh * WMS_PER_WH;
+}
+
+static void energyRunBegin() {
+  g_runMarkWms = g_stepMarkWms = energyNowWms();
+  memset(g_stepWh, 0, sizeof(g_stepWh));
+  g_runStartMs = millis();
+  g_runEndMs   = 0;
+}
+
+// podsumowanie RUN w logu (czas, kWh, kroki profilu)
+static void energyRunEnd() {
+  const bool profile = CFG.mode == MODE_PROFILE && PROFILE_LEN > 0;
+  if (profile) energyStepClose(true);
+  g_runEndMs = millis();
+  const uint32_t wh = energyRunWh();
+  Serial.printf("[CTRL] Run summary: %.1f h, %lu.%03lu kWh (bank %u W x %u)\n",
+                energyRunSec() / 3600.0, (unsigned long)(wh / 1000UL), (unsigned long)(wh % 1000UL),
+                (unsigned)CFG.heat.bankW, (unsigned)SSR_BANKS);
+  if (!profile) return;
+  for (uint8_t i = 0; i < PROFILE_LEN; i++) {
+    if (!g_stepWh[i]) continue;
+    Serial.printf("[CTRL]   step %u: %lu.%03lu kWh\n", (unsigned)(i + 1),
+                  (unsigned long)(g_stepWh[i] / 1000UL), (unsigned long)(g_stepWh[i] % 1000UL));
   }
+}
+
+uint32_t energyRunWh() {
+  return (uint32_t)((energyNowWms() - g_runMarkWms) / WMS_PER_WH);
+}
 
-  double duty = PID_OUT;
-  if (!isfinite(duty)) duty = 0.0;
-  if (duty < 0.0) duty = 0.0;
-  if (duty > 100.0) duty = 100.0;
+uint32_t energyRunSec() {
+  if (!g_runStartMs) return 0;
+  return ((g_runEndMs ? g_runEndMs : millis()) - g_runStartMs) / 1000UL;
+}
 
-  unsigned long onMs = (unsigned long)(duty * (double)WINDOW_MS / 100.0);
-  bool on = RUN_ACTIVE && !SAFETY_TRIP && (nowMs - WINDOW_START < onMs);
-  ssrWrite(on);
+// po wznowieniu RUN: energia i czas sprzed przerwy (znaczniki modulo – bez przepełnień)
+static void energyRunRestore(uint32_t wh, uint32_t sec) {
+  g_runMarkWms -= (uint64_t)wh * WMS_PER_WH;
+  g_runStartMs -= sec * 1000UL;
+}
+
+uint32_t energyStepWh(uint8_t idx) {
+  if (idx >= PROFILE_MAX_STEPS) return 0;
+  uint32_t wh = g_stepWh[idx];
+  if (RUN_ACTIVE && idx == PROFILE_ACTIVE && CFG.mode == MODE_PROFILE) {
+    wh += (uint32_t)((energyNowWms() - g_stepMarkWms) / WMS_PER_WH);
+  }
+  return wh;
 }
 
 // próbki do bufora – max ~1 próbkowanie na sekundę
@@ -166,32 +828,318 @@ static void updateSamples(unsigned long nowMs) {
   lastSampleMs = nowMs;
 
   uint16_t heat = (uint16_t)(HEATER_ON ? 1u : 0u);
+  const uint32_t wh = RUN_ACTIVE ? energyRunWh() : 0;
+  const uint16_t teq = (uint16_t)(HEAT_TEQ_MILLI / 1000);
 
   if (S_LEN < S_CAP) {
-    SAMPLES[S_LEN++] = { RUN_REV, (float)KILN_TEMP, (float)PID_OUT, heat };
+    SAMPLES[S_LEN++] = { RUN_REV, g_lastSampleMs, (float)KILN_TEMP, (float)PID_OUT, heat, teq, wh };
   } else {
     // przesuwamy bufor o 1 w lewo
     memmove(&SAMPLES[0], &SAMPLES[1], sizeof(Sample) * (S_CAP - 1));
-    SAMPLES[S_CAP - 1] = { RUN_REV, (float)KILN_TEMP, (float)PID_OUT, heat };
+    SAMPLES[S_CAP - 1] = { RUN_REV, g_lastSampleMs, (float)KILN_TEMP, (float)PID_OUT, heat, teq, wh };
+  }
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Praca cieplna RUN – całka czas–temperatura z każdej ramki (heat_work.h), z termopary przy
+// wyrobie, gdy jest; stożek może zakończyć hold kroku (ProfileStep.cone)
+// ────────────────────────────────────────────────────────────────────────────────
+
+static const uint32_t HEAT_GAP_MAX_MS = 10000UL;   // dłuższa dziura w pomiarach się nie liczy
+
+static HeatWork HEATWORK;
+
+// nowy RUN (teqMilli = 0) albo wznowienie z checkpointu
+static void heatWorkBegin(int32_t teqMilli) {
+  HEATWORK.restore(teqMilli);
+  HEAT_TEQ_MILLI = HEATWORK.teqMilli();
+  HEAT_CONE      = HEATWORK.cone();
+}
+
+static void heatWorkAdd(int32_t tempMilli, uint32_t dtMs) {
+  if (dtMs > HEAT_GAP_MAX_MS) return;
+  HEATWORK.add(tempMilli, dtMs);
+  HEAT_TEQ_MILLI = HEATWORK.teqMilli();
+  if (HEATWORK.cone() != HEAT_CONE) {
+    HEAT_CONE = HEATWORK.cone();
+    Serial.printf("[CTRL] Heat work: cone %s (Teq %.0f C)\n", coneName(HEAT_CONE), HEAT_TEQ_MILLI / 1000.0);
+  }
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Checkpoint RUN – wznowienie po zaniku zasilania (storage.h: RTC + flash)
+// ────────────────────────────────────────────────────────────────────────────────
+// Tick tylko wypełnia rekord i kopiuje go do pamięci RTC (µs); zapis do flash robi
+// checkpointLoop() w loop() – rzadko, od razu po zmianie segmentu profilu.
+
+static const uint32_t CKPT_PERIOD_MS   = 5000UL;    // rekord do RTC co 5 s
+static const uint32_t RESUME_WINDOW_MS = 60000UL;   // bez poprawnego pomiaru po starcie → bez wznowienia
+
+static uint32_t g_ckptLastMs    = 0;
+static bool     g_ckptUrgent    = false;   // zmiana segmentu – flash od razu
+static uint32_t g_profileCrc    = 0;       // program bieżącego RUN
+static bool     g_resumePending = true;
+
+static void checkpointTick(uint32_t now) {
+  if (!RUN_ACTIVE || SAFETY_TRIP || CFG.mode == MODE_AUTOTUNE) return;
+  if (!g_ckptUrgent && now - g_ckptLastMs < CKPT_PERIOD_MS) return;
+  g_ckptLastMs = now;
+
+  RunCheckpoint cp;
+  memset(&cp, 0, sizeof(cp));
+  cp.active    = 1;
+  cp.mode      = CFG.mode;
+  cp.runRev    = RUN_REV;
+  cp.setMilli  = (int32_t)lround(PID_SET * 1000.0);
+  cp.tempMilli = (int32_t)(((int64_t)g_kilnQ16 * 1000) >> 16);
+  cp.runSec    = energyRunSec();
+  cp.runWh     = energyRunWh();
+  cp.heatTeqMilli = HEAT_TEQ_MILLI;
+  if (CFG.mode == MODE_PROFILE && g_planSeg < PROFILE_PLAN.len) {
+    cp.profileCrc = g_profileCrc;
+    cp.step       = PROFILE_ACTIVE;
+    cp.segKind    = PROFILE_PLAN.seg[g_planSeg].kind;
+    cp.phase      = PROFILE_PHASE;
+    cp.inSegMs    = now - g_segStartMs;
+  }
+  checkpointPut(cp, g_ckptUrgent);
+  g_ckptUrgent = false;
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// ETA programu – oś planu (nominalnie) + to, czego plan nie wie: gwarantowane wytrzymanie
+// (bandC) i rampa studzenia czekają na piec, gdy rampa jest szybsza niż piec daje radę
+// przy pełnej mocy (w dół – stygnąc bez grzania). Opóźnienia przyszłych kroków liczone raz – przy
+// kompilacji planu i zmianie modelu – do sum od końca; w ticku tylko odczyt sumy,
+// a bieżący krok (z pomiaru) co ramkę.
+// ────────────────────────────────────────────────────────────────────────────────
+
+static uint32_t g_etaTailSec[PROFILE_MAX_STEPS + 1];   // Σ opóźnień kroków ≥ i [s]
+static uint32_t g_etaLiveSec = 0;                      // opóźnienie bieżącego kroku [s]
+
+static uint32_t etaAdd(uint32_t a, uint32_t b) {
+  return (b >= PROFILE_ETA_UNKNOWN - a) ? PROFILE_ETA_UNKNOWN : a + b;
+}
+
+// górna granica wypełnienia przy dojściu (limit PID i limit mocy sekcji)
+static double etaDutyPct() {
+  const double cap = q16ToDouble(g_dutyMaxQ16);
+  return CFG.pid.outMax < cap ? CFG.pid.outMax : cap;
+}
+
+static const double COOL_LAG_C = 10.0;   // rampa studzenia czeka, gdy piec jest wyżej o tyle (niżej)
+
+// ile dłużej niż rampSec (nominalna reszta rampy) piec będzie szedł od fromC do pasma
+// kroku st; limit czekania maxWaitMin obcina, bez niego nieosiągalne = PROFILE_ETA_UNKNOWN
+static uint32_t etaStepDelaySec(const ProfileStep& st, double fromC, double rampSec) {
+  const bool up  = st.targetC >= fromC;
+  double     tol = st.bandC;
+  // rampa studzenia kończy się dopiero, gdy piec dojdzie do COOL_LAG_C od celu
+  if (!up && st.rampDownCph && (!tol || tol > COOL_LAG_C)) tol = COOL_LAG_C;
+  if (!tol) return 0;        // hold od końca rampy – plan się nie przesuwa
+  const double toC = up ? st.targetC - tol : st.targetC + tol;
+  double t = plantSecondsOnRamp(plantModelActive(), fromC, toC,
+                                up ? st.rampCph : st.rampDownCph, etaDutyPct());
+  if (isnan(t)) return 0;    // bez modelu – tylko oś planu
+  t -= rampSec;
+  if (!(t > 0.0)) return 0;
+  const double cap = st.maxWaitMin ? st.maxWaitMin * 60.0 : INFINITY;
+  if (t > cap) t = cap;
+  return isfinite(t) ? (uint32_t)t : PROFILE_ETA_UNKNOWN;
+}
+
+// sumy opóźnień od końca dla kroków planu; start programu z fromMilli pierwszego segmentu
+static void etaPlanInit() {
+  g_etaTailSec[PROFILE_MAX_STEPS] = 0;
+  uint8_t first = PROFILE_PLAN.len ? PROFILE_PLAN.seg[0].step : PROFILE_LEN;
+  for (int i = PROFILE_MAX_STEPS - 1; i >= 0; i--) {
+    uint32_t d = 0;
+    if (i >= first && i < PROFILE_LEN) {
+      const ProfileStep& st = PROFILE[i];
+      const double fromC = (i == first) ? PROFILE_PLAN.seg[0].fromMilli / 1000.0 : PROFILE[i - 1].targetC;
+      const uint16_t rate = (st.targetC >= fromC) ? st.rampCph : st.rampDownCph;
+      d = etaStepDelaySec(st, fromC, rate ? fabs(st.targetC - fromC) * 3600.0 / rate : 0.0);
+    }
+    g_etaTailSec[i] = etaAdd(g_etaTailSec[i + 1], d);
+  }
+  g_etaLiveSec = 0;
+
+  // przed startem – cały program od temperatury, z której go skompilowano
+  if (!RUN_ACTIVE) {
+    PROFILE_ETA_SEC = (PROFILE_PLAN.len && PROFILE_PLAN.totalMs != PLAN_INFINITE)
+                    ? etaAdd(PROFILE_PLAN.totalMs / 1000UL, g_etaTailSec[first]) : PROFILE_ETA_UNKNOWN;
+  }
+}
+
+// bieżący krok z pomiaru (co ramkę): rampa – zostało rampSec nominalnie; WAIT – dojście do pasma
+static void etaLiveUpdate(uint32_t now, const PlanSeg& sg, uint32_t inSeg) {
+  const ProfileStep& st = PROFILE[sg.step];
+  if (PROFILE_PHASE == PHASE_RAMP) {
+    g_etaLiveSec = etaStepDelaySec(st, KILN_TEMP, inSeg < sg.durMs ? (sg.durMs - inSeg) / 1000.0 : 0.0);
+  } else if (PROFILE_PHASE == PHASE_WAIT) {
+    ProfileStep jump = st;   // z bieżącej temperatury – już bez rampy
+    jump.rampCph = jump.rampDownCph = 0;
+    if (st.maxWaitMin) {
+      const uint32_t waited = (now - g_waitStartMs) / 60000UL;
+      jump.maxWaitMin = waited < st.maxWaitMin ? st.maxWaitMin - waited : 1;
+    }
+    g_etaLiveSec = etaStepDelaySec(jump, KILN_TEMP, 0.0);
+  } else {
+    g_etaLiveSec = 0;
   }
 }
 
+// co tick: reszta osi planu + bieżący krok + przyszłe kroki (suma gotowa)
+static uint32_t profileEtaSec(const PlanSeg& sg, uint32_t inSeg) {
+  if (PROFILE_PLAN.totalMs == PLAN_INFINITE) return PROFILE_ETA_UNKNOWN;
+  const uint32_t pos = sg.startMs + inSeg;
+  const uint32_t nom = PROFILE_PLAN.totalMs > pos ? (PROFILE_PLAN.totalMs - pos) / 1000UL : 0;
+  return etaAdd(etaAdd(nom, g_etaLiveSec), g_etaTailSec[sg.step + 1]);
+}
+
 // ────────────────────────────────────────────────────────────────────────────────
-// PROFIL – wewnętrzna pomocnicza: skok na etap
+// Studzenie kontrolowane – rampa w dół (rampDownCph) to zadana, za którą PID dogrzewa
+// (feed-forward z nachyleniem ujemnym zmniejsza moc tylko tyle, ile trzeba). Gdy piec
+// stygnie sam wolniej niż rampa – grzałki wyłączone, a piec wyżej niż zadana o
+// COOL_LAG_C – generator zadanej stoi (jak WAIT przy holdzie): zadana nie ucieka od
+// pieca, rampa trwa tyle, ile piec naprawdę stygnie. maxWaitMin kroku ogranicza łączne
+// wstrzymanie (potem rampa idzie nominalnie), żeby cel przy otoczeniu nie zawiesił programu.
 // ────────────────────────────────────────────────────────────────────────────────
+
+static const q16_t COOL_IDLE_Q16 = Q16_ONE / 2;   // ≤ 0.5 % – grzałki praktycznie wyłączone
+
+static uint32_t g_coolLastMs = 0;   // poprzedni tick rampy
+static uint32_t g_coolHeldMs = 0;   // łącznie wstrzymane w tej rampie
+
+static void coolTrack(uint32_t now, const PlanSeg& sg, const ProfileStep& st) {
+  const uint32_t dt    = now - g_coolLastMs;
+  const uint32_t inSeg = now - g_segStartMs;
+  g_coolLastMs = now;
+
+  const double spC = planSetpointMilli(sg, inSeg < sg.durMs ? inSeg : sg.durMs) / 1000.0;
+  const bool lag = sg.slopeMph < 0 && g_dutyQ16 <= COOL_IDLE_Q16 &&
+                   programTempC() - spC > COOL_LAG_C &&
+                   (!st.maxWaitMin || g_coolHeldMs < (uint32_t)st.maxWaitMin * 60000UL);
+  if (lag && !PROFILE_COOL_LAG) {
+    Serial.printf("[CTRL] Step %u: natural cooling %.0f C/h slower than ramp %u C/h – ramp follows the kiln\n",
+                  (unsigned)(sg.step + 1), -KILN_RATE_CPH, (unsigned)st.rampDownCph);
+  }
+  PROFILE_COOL_LAG = lag;
+  if (lag) {
+    g_segStartMs += dt;
+    g_coolHeldMs += dt;
+  }
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// PROFIL – wewnętrzne pomocnicze: start etapu (rampa) i skok na etap
+// ────────────────────────────────────────────────────────────────────────────────
+
+// wejście w segment planu idx, rozpoczęty w chwili startMs (ms od startu MCU)
+static void profileEnterSeg(uint8_t idx, uint32_t startMs) {
+  const PlanSeg& sg = PROFILE_PLAN.seg[idx];
+  g_planSeg    = idx;
+  g_segStartMs = startMs;
+  g_coolLastMs = millis();
+  g_coolHeldMs = 0;
+  PROFILE_COOL_LAG = false;
+
+  if (idx == 0 || PROFILE_PLAN.seg[idx - 1].step != sg.step) {
+    energyStepClose(RUN_ACTIVE);   // energia dotąd – do kroku, który się kończy
+    PROFILE_ACTIVE       = sg.step;
+    g_profileStepStartMs = startMs;
+  }
+
+  if (!RUN_ACTIVE)            PROFILE_PHASE = PHASE_IDLE;
+  else if (sg.kind == SEG_RAMP) PROFILE_PHASE = PHASE_RAMP;
+  else PROFILE_PHASE = PROFILE[sg.step].bandC ? PHASE_WAIT : PHASE_HOLD;
+  g_waitStartMs = startMs;
+  g_ckptUrgent  = RUN_ACTIVE;
+
+  PID_SET = sg.fromMilli / 1000.0;
+}
+
+// kompilacja od kroku first z rampą od fromC i wejście w jego pierwszy segment
+static void profileStartFrom(uint8_t first, double fromC) {
+  const int32_t from = isfinite(fromC) ? (int32_t)lround(fromC * 1000.0)
+                                       : (int32_t)lround(PROFILE[first].targetC * 1000.0);
+  planCompile(PROFILE_PLAN, PROFILE, PROFILE_LEN, first, from);
+  etaPlanInit();
+  profileEnterSeg(0, millis());
+  PROFILE_ELAPSED_SEC = 0;
+  PROFILE_REMAIN_SEC  = PROFILE_PLAN.len ? planStepEndMs(PROFILE_PLAN, 0) / 1000UL : 0;
+}
+
+const char* profilePhaseName(uint8_t phase) {
+  switch (phase) {
+    case PHASE_RAMP: return "ramp";
+    case PHASE_WAIT: return "wait";
+    case PHASE_HOLD: return "hold";
+    default:         return "idle";
+  }
+}
+
 static void profileGotoStep(uint8_t idx) {
   if (idx >= PROFILE_LEN) return;
-  PROFILE_ACTIVE = idx;
-  g_profileStepStartMs = millis();
-  PROFILE_ELAPSED_SEC  = 0;
-  PROFILE_REMAIN_SEC   = PROFILE[PROFILE_ACTIVE].holdSec;
-  PID_SET = PROFILE[PROFILE_ACTIVE].targetC;
+  profileStartFrom(idx, PID_SET);   // rampa od bieżącej zadanej (też gdy skok w trakcie rampy)
+  pidBumpless(g_dutyQ16);
   Serial.print(F("[CTRL] Profile step="));
   Serial.print(PROFILE_ACTIVE + 1);
   Serial.print('/');
   Serial.println(PROFILE_LEN);
 }
 
+// wznowienie przerwanego RUN – przy pierwszym poprawnym pomiarze po starcie.
+// Tryb z checkpointu, nie z CFG: po starcie profileLoaded() ustawia MODE_PROFILE, gdy
+// tylko profil jest zapisany, więc CFG.mode nie mówi, w czym RUN był przerwany.
+static void runTryResume() {
+  RunCheckpoint cp;
+  if (!checkpointLoad(cp) || !cp.active) return;
+
+  const double tCp  = cp.tempMilli / 1000.0;
+  const double drop = tCp - KILN_TEMP;
+  // przerwa z modelu stygnięcia (0 % mocy); bez modelu zostaje kryterium spadku
+  const double offSec = (drop > 0) ? plantSecondsToReach(plantModelActive(), tCp, KILN_TEMP, 0.0) : 0.0;
+
+  const char* why = nullptr;
+  if (!CFG.resume.en)                  why = "disabled";
+  else if (cp.mode != MODE_DYNAMIC && cp.mode != MODE_PROFILE) why = "bad mode";
+  else if (drop > CFG.resume.maxDropC) why = "kiln cooled";
+  else if (isfinite(offSec) && offSec > CFG.resume.maxOffMin * 60.0) why = "outage too long";
+  else if (cp.mode == MODE_PROFILE &&
+           (cp.step >= PROFILE_LEN || profileCrc(PROFILE, PROFILE_LEN) != cp.profileCrc)) why = "profile changed";
+  if (why) {
+    Serial.printf("[CTRL] Resume skipped (%s): rev=%lu T=%.0f->%.0f\n",
+                  why, (unsigned long)cp.runRev, tCp, KILN_TEMP);
+    checkpointClear();
+    return;
+  }
+
+  CFG.mode = (Mode)cp.mode;
+  RUN_REV = cp.runRev - 1;   // runStart() → ten sam numer RUN (ciągłość próbek)
+  if (cp.mode == MODE_PROFILE) PROFILE_ACTIVE = cp.step;
+  else                         PID_SET = cp.setMilli / 1000.0;
+  runStart();                  // profil: rampa bieżącego kroku od obecnej temperatury
+  energyRunRestore(cp.runWh, cp.runSec);
+  heatWorkBegin(cp.heatTeqMilli);
+
+  // wytrzymanie w toku: bez ponownej rampy, zaliczony czas zostaje (przerwa się nie liczy)
+  if (cp.mode == MODE_PROFILE && cp.segKind == SEG_HOLD && cp.phase == PHASE_HOLD) {
+    uint8_t h = 0;
+    while (h < PROFILE_PLAN.len && PROFILE_PLAN.seg[h].kind != SEG_HOLD) h++;
+    if (h < PROFILE_PLAN.len) {
+      const uint32_t dur  = PROFILE_PLAN.seg[h].durMs;
+      const uint32_t done = (dur != PLAN_INFINITE && cp.inSegMs > dur) ? dur : cp.inSegMs;
+      profileEnterSeg(h, millis() - done);
+      PROFILE_PHASE = PHASE_HOLD;
+    }
+  }
+  Serial.printf("[CTRL] Run resumed: rev=%lu %s step=%u T=%.0f->%.0f off~%.0fs\n",
+                (unsigned long)RUN_REV, cp.mode == MODE_PROFILE ? "profile" : "dynamic",
+                (unsigned)(PROFILE_ACTIVE + 1), tCp, KILN_TEMP,
+                isfinite(offSec) ? offSec : 0.0);
+}
+
 // ────────────────────────────────────────────────────────────────────────────────
 // API z control.h
 // ────────────────────────────────────────────────────────────────────────────────
@@ -200,6 +1148,9 @@ static void profileGotoStep(uint8_t idx) {
 void pinsAndBusesInit() {
   // GPIO
   if (CFG.pins.SSR  >= 0) { pinMode(CFG.pins.SSR,  OUTPUT); digitalWrite(CFG.pins.SSR, LOW); }
+  if (CFG.pins.SSR2 >= 0) { pinMode(CFG.pins.SSR2, OUTPUT); digitalWrite(CFG.pins.SSR2, LOW); }
+  if (CFG.pins.SSR3 >= 0) { pinMode(CFG.pins.SSR3, OUTPUT); digitalWrite(CFG.pins.SSR3, LOW); }
+  heaterBanksInit();
   if (CFG.pins.LED  >= 0) { pinMode(CFG.pins.LED,  OUTPUT); digitalWrite(CFG.pins.LED, HIGH); }
   if (CFG.pins.BUZZ >= 0) { pinMode(CFG.pins.BUZZ, OUTPUT); digitalWrite(CFG.pins.BUZZ, LOW); }
 
@@ -207,14 +1158,51 @@ void pinsAndBusesInit() {
   Wire.begin(CFG.pins.I2C_SDA, CFG.pins.I2C_SCL);
   delay(50); // mała przerwa po starcie I2C
 
-  // MAX31855 – SoftSPI na pinach z CFG
-  if (THERMO) {
-    delete THERMO;
-    THERMO = nullptr;
+  // MAX31855 – soft-SPI na pinach z CFG, czytany z przerwania (wstrzymane na czas podmiany);
+  // drugi układ (termopara przy wyrobie) – wspólne SCK/MISO, własny CS
+  g_tcReady = false;
+  pinMode(CFG.pins.SPI_SCK, OUTPUT);
+  digitalWrite(CFG.pins.SPI_SCK, LOW);
+  pinMode(CFG.pins.SPI_MISO, INPUT);
+  pinMode(CFG.pins.SPI_CS, OUTPUT);
+  digitalWrite(CFG.pins.SPI_CS, HIGH);
+  if (CFG.pins.SPI_CS2 >= 0) {
+    pinMode(CFG.pins.SPI_CS2, OUTPUT);
+    digitalWrite(CFG.pins.SPI_CS2, HIGH);
   }
-  THERMO = new Adafruit_MAX31855(CFG.pins.SPI_SCK,
-                                 CFG.pins.SPI_CS,
-                                 CFG.pins.SPI_MISO);
+  g_tcSck  = isrPin(CFG.pins.SPI_SCK);
+  g_tcMiso = isrPin(CFG.pins.SPI_MISO);
+  g_tcCs   = isrPin(CFG.pins.SPI_CS);
+  g_tcCs2  = isrPin(CFG.pins.SPI_CS2);
+  g_tcReady = true;
+  ctrlTimerBegin();
+}
+
+// nastawy z CFG – przy starcie i po zmianie konfiguracji (autotune)
+// same nastawy CFG.pid (+ harmonogram) do regulatora, z bieżącymi mnożnikami adaptacji.
+// Nic poza PID: modulator SSR, sekcje, nadzór i ocena pętli pracują dalej (autotune w RUN)
+static void pidReloadGains() {
+#if USE_FIXEDPID
+  gainScheduleInit();
+#endif
+  adaptApply();
+}
+
+void pidApplyConfig() {
+#if USE_FIXEDPID
+  PIDCTL.setShaping(CFG.pid.spWeight, CFG.pid.dFilterN, CFG.pid.awTrackSec);
+#endif
+  // nowe nastawy bazowe – korekty adaptacji liczone od nich od zera
+  LOOP_KP_MUL  = 1.0f;
+  LOOP_KI_MUL  = 1.0f;
+  LOOP_ADAPT_N = 0;
+  LOOPMON.reset(millis());
+  pidReloadGains();
+
+  modelApply();
+  heaterBanksInit();
+  safetyApplyConfig();
+  cascadeApplyConfig();
 }
 
 // konfiguracja PID – używamy pól Kp, Ki, Kd z CFG.pid
@@ -222,17 +1210,18 @@ void controlSetup() {
   // najpierw piny / I2C / MAX
   pinsAndBusesInit();
   
-#if USE_QUICKPID
-  PIDCTL.SetTunings(CFG.pid.Kp, CFG.pid.Ki, CFG.pid.Kd);
+  TEMPEST.begin(THERMO_PERIOD_MS);
+  pidApplyConfig();
+#if USE_FIXEDPID
+  PIDCTL.setOutputLimits(0, 100 * Q16_ONE);
+#elif USE_QUICKPID
   PIDCTL.SetOutputLimits(0, 100);
 #else
-  PIDCTL.SetTunings(CFG.pid.Kp, CFG.pid.Ki, CFG.pid.Kd);
   PIDCTL.SetOutputLimits(0, 100);
   PIDCTL.SetMode(AUTOMATIC);
 #endif
 
   PID_SET = CFG.pid.setpointC;
-  WINDOW_START = millis();
 
   PROFILE_ACTIVE = 0;
   PROFILE_LEN    = 0;
@@ -248,18 +1237,118 @@ void runStart() {
   }
   RUN_ACTIVE = true;
   RUN_REV++;
+  energyRunBegin();
+  heatWorkBegin(0);
+  g_profileCrc = (CFG.mode == MODE_PROFILE) ? profileCrc(PROFILE, PROFILE_LEN) : 0;
+  g_ckptUrgent = true;
 
-  // przy starcie profilu zresetuj licznik etapu
+  // przy starcie profilu zresetuj licznik etapu – rampa od bieżącej temperatury pieca
   if (CFG.mode == MODE_PROFILE && PROFILE_LEN > 0) {
-    g_profileStepStartMs = millis();
-    PROFILE_ELAPSED_SEC  = 0;
-    PROFILE_REMAIN_SEC   = PROFILE[PROFILE_ACTIVE].holdSec;
+    const double fromC = programTempC();
+    profileStartFrom(PROFILE_ACTIVE, isfinite(fromC) ? fromC : PID_SET);
   }
+
+  // start od zera – bez całki nabitej w czasie postoju
+  pidBumpless(0);
 }
 
 void runStop() {
+  const bool wasActive = RUN_ACTIVE;
   RUN_ACTIVE = false;
-  ssrWrite(false);
+  PROFILE_PHASE = PHASE_IDLE;
+  PROFILE_COOL_LAG = false;
+  ssrWrite(0);
+  if (wasActive) energyRunEnd();
+  checkpointClear();
+  if (CFG.mode == MODE_PROFILE) etaPlanInit();   // znowu podgląd całego programu
+
+  // stop w trakcie autotune = przerwanie; wracamy do poprzedniego trybu
+  AUTOTUNE.cancel();
+  if (CFG.mode == MODE_AUTOTUNE) CFG.mode = g_atPrevMode;
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// AUTOTUNE
+// ────────────────────────────────────────────────────────────────────────────────
+bool autotuneStart(double spC, double hystC) {
+  if (SAFETY_TRIP || !SENSOR_OK || AUTOTUNE.state() == AT_RUNNING) return false;
+  if (!(spC > 0 && spC <= CFG.maxTempC) || !(hystC >= 0 && hystC <= 20)) return false;
+
+  if (CFG.mode != MODE_AUTOTUNE) g_atPrevMode = CFG.mode;
+  CFG.mode = MODE_AUTOTUNE;
+  PID_SET  = spC;
+
+  // środek przekaźnika z modelu (wypełnienie utrzymujące zadaną) – mniej cykli na wyrównanie
+  q16_t bias = 50 * Q16_ONE;
+  const PlantModel& m = plantModelActive();
+  if (m.K > 0.0f) bias = q16FromDouble((spC - m.ambC) / m.K);
+  AUTOTUNE.start(millis(), q16FromDouble(spC), q16FromDouble(hystC), bias, g_dutyMaxQ16);
+  runStart();
+  Serial.printf("[CTRL] Autotune start sp=%.0f hyst=%.1f\n", spC, hystC);
+  return true;
+}
+
+const RelayAutotune& autotuneInfo() { return AUTOTUNE; }
+
+bool autotuneApply() {
+  if (AUTOTUNE.state() != AT_DONE) return false;
+  const AutotuneResult& r = AUTOTUNE.result();
+  CFG.pid.Kp = r.Kp;
+  CFG.pid.Ki = r.Ki;
+  CFG.pid.Kd = r.Kd;
+
+  // z harmonogramem nastaw: punkt w temperaturze strojenia (zastąp bliski ±5 °C albo wstaw)
+  if (CFG.pid.schedN > 0) {
+    const float t = (float)q16ToDouble(AUTOTUNE.setpoint());
+    const GainPoint gp = { t, (float)r.Kp, (float)r.Ki, (float)r.Kd };
+    uint8_t i = 0;
+    while (i < CFG.pid.schedN && CFG.pid.sched[i].tempC < t - 5.0f) i++;
+    if (i < CFG.pid.schedN && fabsf(CFG.pid.sched[i].tempC - t) <= 5.0f) {
+      CFG.pid.sched[i] = gp;
+    } else if (CFG.pid.schedN < GAIN_SCHED_MAX) {
+      for (uint8_t j = CFG.pid.schedN; j > i; j--) CFG.pid.sched[j] = CFG.pid.sched[j - 1];
+      CFG.pid.sched[i] = gp;
+      CFG.pid.schedN++;
+    }
+  }
+
+  cfgSave();
+  pidReloadGains();
+  Serial.printf("[CTRL] Autotune applied Kp=%.3f Ki=%.4f Kd=%.2f\n", r.Kp, r.Ki, r.Kd);
+  return true;
+}
+
+bool plantModelSave() {
+  if (!PLANTID.valid()) return false;
+  CFG.model = PLANTID.model();
+  cfgSave();
+  modelApply();
+  Serial.printf("[CTRL] Model saved K=%.2f tau=%.0fs theta=%.0fs amb=%.1f\n",
+                CFG.model.K, CFG.model.tauSec, CFG.model.deadSec, CFG.model.ambC);
+  return true;
+}
+
+void plantModelReset() {
+  PLANTID.reset();
+  modelApply();
+}
+
+// tick autotune: przekaźnik zamiast PID, po zakończeniu stop RUN
+static void autotuneTick(uint32_t now) {
+  q16_t duty = 0;
+  if (RUN_ACTIVE && !AUTOTUNE.update(now, g_kilnQ16, duty)) {
+    if (AUTOTUNE.state() == AT_DONE) {
+      const AutotuneResult& r = AUTOTUNE.result();
+      Serial.printf("[CTRL] Autotune done Ku=%.3f Pu=%.0fs -> Kp=%.3f Ki=%.4f Kd=%.2f\n",
+                    r.Ku, r.PuSec, r.Kp, r.Ki, r.Kd);
+    } else {
+      Serial.printf("[CTRL] Autotune failed: %s\n", AUTOTUNE.error());
+    }
+    runStop();
+  }
+  g_dutyQ16 = duty;
+  PID_OUT   = q16ToDouble(duty);
+  PID_FF    = 0.0;
 }
 
 /***************************************************************************************
@@ -272,47 +1361,75 @@ void runStop() {
 
 // główna pętla sterowania – wywoływana z loop()
 void controlLoop() {
+  const uint32_t tickStartCycles = ESP.getCycleCount();
   const unsigned long now = millis();
 
-  // Odczyt MAX31855 z throttlingiem
-  static unsigned long lastThermoMs = 0;
-  static double lastThermoC  = NAN;  // temp. pieca
-  static double filteredC = NAN;   // EMA filtrowana temp
-  static double lastBoardC   = NAN;  // temp. sterownika (złącze zimne)
+  // watchdog sterowania – start przy pierwszym ticku, potem odbiór ewentualnego zagłodzenia
+  if (!g_wdRunning) ctrlWatchdogBegin(now);
+  ctrlWatchdogRecover(now);
 
-  if (now - lastThermoMs >= 250UL) {      // max 4 odczyty na sekundę
-    lastThermoMs = now;
+  // Odbiór próbek z kolejki akwizycji (przerwanie timer1)
+  static double lastThermoC = NAN;  // temp. pieca
+  static double lastBoardC  = NAN;  // temp. sterownika (złącze zimne)
+  static double lastWareC   = NAN;  // temp. przy wyrobie (drugi MAX31855)
 
-    // temperatura pieca (termopara)
-    double raw = readTempC();
+  ThermoFrame f;
+  bool  haveFrame = false;
+  q16_t onFrac    = 0;
+  while (THERMO_Q.pop(f)) {
+    // udział SSR od poprzedniej paczki ramek – cała paczka dostaje ten sam
+    if (!haveFrame) { onFrac = ssrOnFracTake(now); haveFrame = true; }
 
-    // temperatura złącza zimnego / układu – traktujemy jako "temp. sterownika"
-    double board = NAN;
-    if (THERMO) {
-      board = THERMO->readInternal();   // funkcja z Adafruit_MAX31855
-    }
+    int16_t tc, cj;
+    bool ok = tcDecodeFrame(f.raw, tc, cj);
 
-    if (isfinite(raw)) {
-      lastThermoC = raw;
+    // temperatura złącza zimnego / układu – traktujemy jako "temp. sterownika"
+    lastBoardC = cj / 16.0;
+
+    // termopara przy wyrobie – ta sama chwila pomiaru; raw2 = 0 → brak układu
+    int16_t tc2, cj2;
+    const bool    ok2  = f.raw2 && tcDecodeFrame(f.raw2, tc2, cj2);
+    const int32_t ware = ok2 ? tcLinearizeCounts(tc2, cj2) : 0;
+    lastWareC = ok2 ? ware / 1000.0 : NAN;
+
+    // korekta NIST ITS-90 – układ liczy liniowo 41.276 µV/°C (patrz thermocouple.cpp)
+    if (ok) {
+      const int32_t mC = tcLinearizeCounts(tc, cj);
+      g_kilnQ16   = q16FromMilli(mC);
+      lastThermoC = mC / 1000.0;
+      TEMPEST.update(g_kilnQ16, onFrac);   // po przerwie w pomiarze startuje od tej próbki
+      if (RUN_ACTIVE) heatWorkAdd(ok2 ? ware : mC, f.ms - g_lastSampleMs);   // stożki stoją przy wyrobie
     } else {
       lastThermoC = NAN;
+      TEMPEST.invalidate();
     }
 
-    // wygładzanie wyników odczytu temperatury (filtr)
-    // if (isfinite(raw)) {
-    //   lastThermoC = raw;
-
-    //   if (!isfinite(filteredC)) filteredC = raw;        // pierwszy pomiar bez filtru
-    //   else filteredC = filteredC * 0.85 + raw * 0.15;  // EMA
-    //   }
+    g_lastSampleMs = f.ms;
+  }
 
+  // ramki utracone przy pełnej kolejce – licznik zmienia ISR, tu tylko kopia i log
+  const uint32_t qDrop = THERMO_Q.dropped();
+  if (qDrop != THERMO_Q_DROPPED) {
+    Serial.printf("[CTRL] Thermo queue full – %lu frame(s) dropped (total %lu)\n",
+                  (unsigned long)(qDrop - THERMO_Q_DROPPED), (unsigned long)qDrop);
+    THERMO_Q_DROPPED = qDrop;
+  }
 
+  // brak świeżych próbek (timer stoi / brak układu) → pomiar nieważny
+  if (now - g_lastSampleMs > 4UL * THERMO_PERIOD_MS) {
+    lastThermoC = NAN;
+    lastBoardC  = NAN;
+    lastWareC   = NAN;
+  }
 
-    if (isfinite(board)) {
-      lastBoardC = board;
-    } else {
-      lastBoardC = NAN;
-    }
+  // zadziałanie nadzoru (piny już zgaszone z ISR) – stop RUN, bez wznowienia po resecie
+  safetyPoll();
+  if (SAFETY_TRIP && !g_tripHandled) {
+    g_tripHandled = true;
+    Serial.printf("[CTRL] SAFETY TRIP: %s (%.1f) – heater off\n",
+                  safetyTripName(SAFETY_REASON), SAFETY.tripMilli() / 1000.0);
+    runStop();
+    buzzStart(3000);
   }
 
   // BUZZER – obsługa czasu trwania sygnału
@@ -322,43 +1439,125 @@ void controlLoop() {
   // Aktualizacja globalnych temperatur
   // ──────────────────────────────────────────────────────────────────────
   KILN_TEMP = lastThermoC;   // temp. pieca
-  // KILN_TEMP = filteredC;
+  if (isfinite(lastThermoC) && TEMPEST.valid()) {
+    KILN_TEMP_EST = q16ToDouble(TEMPEST.temp());
+    KILN_RATE_CPH = q16ToDouble(TEMPEST.rate()) * 3600.0;
+  } else {
+    TEMPEST.invalidate();
+    KILN_TEMP_EST = NAN;
+    KILN_RATE_CPH = 0.0;
+  }
   CTRL_TEMP = lastBoardC;    // temp. sterownika (złącze zimne MAX31855)
+  WARE_TEMP = lastWareC;     // temp. przy wyrobie (NAN bez drugiego układu)
   SENSOR_OK = isfinite(KILN_TEMP);
 
+  // po starcie: przerwany RUN z checkpointu (raz, gdy jest pomiar)
+  if (g_resumePending) {
+    if (RUN_ACTIVE || now > RESUME_WINDOW_MS) g_resumePending = false;
+    else if (haveFrame && SENSOR_OK) { g_resumePending = false; runTryResume(); }
+  }
+
+  // zmiana trybu (dynamiczny ↔ profil) z WWW – przejęcie PID bez uderzenia
+  static Mode lastMode = CFG.mode;
+  if (CFG.mode != lastMode) {
+    lastMode = CFG.mode;
+    // zmiana trybu z WWW w trakcie autotune – przerwij eksperyment
+    if (CFG.mode != MODE_AUTOTUNE && AUTOTUNE.state() == AT_RUNNING) {
+      AUTOTUNE.cancel();
+      Serial.println(F("[CTRL] Autotune cancelled (mode change)"));
+    }
+    pidBumpless(g_dutyQ16);
+  }
+
   // ──────────────────────────────────────────────────────────────────────
   // LOGIKA PROFILU
   // ──────────────────────────────────────────────────────────────────────
   if (CFG.mode == MODE_PROFILE && PROFILE_LEN > 0) {
-    if (RUN_ACTIVE && SENSOR_OK) {
-      ProfileStep &step = PROFILE[PROFILE_ACTIVE];
-      uint32_t hold = step.holdSec;           // sekundy
-      uint32_t elapsedMs = now - g_profileStepStartMs;
-
-      PROFILE_ELAPSED_SEC = elapsedMs / 1000UL;
-
-      if (hold > 0) {
-        if (PROFILE_ELAPSED_SEC >= hold) {
-          // koniec etapu → kolejny
-          if (PROFILE_ACTIVE + 1 < PROFILE_LEN) {
-            profileGotoStep(PROFILE_ACTIVE + 1);
-          } else {
-            // ostatni etap zakończony – stop grzania
-            RUN_ACTIVE = false;
-            ssrWrite(false);
-            PROFILE_REMAIN_SEC = 0;
-            Serial.println(F("[CTRL] Profile finished – RUN stopped"));
+    if (RUN_ACTIVE && SENSOR_OK && PROFILE_PLAN.len > 0) {
+      const PlanSeg* sg = &PROFILE_PLAN.seg[g_planSeg];
+
+      // rampa studzenia szybsza niż piec stygnie sam – generator zadanej czeka na piec
+      if (sg->kind == SEG_RAMP) coolTrack(now, *sg, PROFILE[sg->step]);
+
+      // koniec rampy → hold tego samego kroku (oś planu bez poślizgu)
+      if (sg->kind == SEG_RAMP && now - g_segStartMs >= sg->durMs) {
+        profileEnterSeg(g_planSeg + 1, g_segStartMs + sg->durMs);
+        sg = &PROFILE_PLAN.seg[g_planSeg];
+      }
+
+      const ProfileStep &step = PROFILE[sg->step];
+
+      // czekamy, aż piec naprawdę wejdzie w pasmo – inaczej hold mógłby minąć „w drodze”
+      if (PROFILE_PHASE == PHASE_WAIT) {
+        const bool inBand  = fabs(programTempC() - step.targetC) <= step.bandC;
+        const bool timeout = step.maxWaitMin > 0 &&
+                             (now - g_waitStartMs) >= (uint32_t)step.maxWaitMin * 60000UL;
+        if (inBand || timeout) {
+          PROFILE_PHASE = PHASE_HOLD;
+          if (timeout && !inBand) {
+            Serial.printf("[CTRL] Step %u: band not reached in %u min – hold starts anyway\n",
+                          (unsigned)(sg->step + 1), (unsigned)step.maxWaitMin);
           }
+        }
+        g_segStartMs = now;   // hold rusza od chwili wejścia w pasmo
+      }
+
+      // koniec holdu → następny segment albo koniec programu; stożek kończy hold przed
+      // czasem – oś planu rusza wtedy od teraz
+      const bool holdTime = sg->durMs != PLAN_INFINITE && now - g_segStartMs >= sg->durMs;
+      const bool holdCone = step.cone && HEATWORK.reached(step.cone - 1);
+      if (PROFILE_PHASE == PHASE_HOLD && (holdTime || holdCone)) {
+        const uint32_t holdEndMs = holdTime ? g_segStartMs + sg->durMs : now;
+        if (holdCone && !holdTime) {
+          Serial.printf("[CTRL] Step %u: cone %s reached after %lu min hold – hold ends\n",
+                        (unsigned)(sg->step + 1), coneName(step.cone - 1),
+                        (unsigned long)((now - g_segStartMs) / 60000UL));
+        }
+        if (g_planSeg + 1 < PROFILE_PLAN.len) {
+          profileEnterSeg(g_planSeg + 1, holdEndMs);
+          sg = &PROFILE_PLAN.seg[g_planSeg];
+          pidBumpless(g_dutyQ16);
+          Serial.print(F("[CTRL] Profile step="));
+          Serial.print(PROFILE_ACTIVE + 1);
+          Serial.print('/');
+          Serial.println(PROFILE_LEN);
         } else {
-          PROFILE_REMAIN_SEC = hold - PROFILE_ELAPSED_SEC;
+          // ostatni etap zakończony – stop grzania
+          RUN_ACTIVE = false;
+          PROFILE_PHASE = PHASE_IDLE;
+          PROFILE_COOL_LAG = false;
+          ssrWrite(0);
+          PROFILE_REMAIN_SEC = 0;
+          PROFILE_ETA_SEC    = 0;
+          Serial.println(F("[CTRL] Profile finished – RUN stopped"));
+          energyRunEnd();
+          checkpointClear();
         }
-      } else {
-        // holdSec == 0 → nieskończony etap
-        PROFILE_REMAIN_SEC = 0;
       }
 
-      // zadana temperatura z aktualnego kroku
-      PID_SET = step.targetC;
+      if (RUN_ACTIVE) {
+        // zadana i czasy etapu – jedno odwołanie do segmentu
+        const uint32_t inSeg = now - g_segStartMs;
+        PID_SET = (sg->kind == SEG_RAMP) ? planSetpointMilli(*sg, inSeg) / 1000.0 : step.targetC;
+
+        PROFILE_ELAPSED_SEC = (now - g_profileStepStartMs) / 1000UL;
+        const uint32_t stepEnd = planStepEndMs(PROFILE_PLAN, g_planSeg);
+        PROFILE_REMAIN_SEC = (stepEnd == PLAN_INFINITE) ? 0   // holdSec == 0 → nieskończony etap
+                           : (stepEnd - sg->startMs - inSeg) / 1000UL;
+
+        // czekanie na pasmo: dojście wg modelu przy pełnej mocy (w dół – bez grzania)
+        if (PROFILE_PHASE == PHASE_WAIT && PROFILE_REMAIN_SEC) {
+          const bool   up  = KILN_TEMP < step.targetC;
+          const double eta = plantSecondsToReach(plantModelActive(), KILN_TEMP,
+                                                 up ? step.targetC - step.bandC : step.targetC + step.bandC,
+                                                 up ? CFG.pid.outMax : 0.0);
+          if (isfinite(eta)) PROFILE_REMAIN_SEC += (uint32_t)eta;
+        }
+
+        // cały program: opóźnienie bieżącego kroku z pomiaru tylko przy nowej ramce
+        if (haveFrame) etaLiveUpdate(now, *sg, inSeg);
+        PROFILE_ETA_SEC = profileEtaSec(*sg, inSeg);
+      }
     } else {
       // nie biegniemy (RUN_STOP / brak czujnika) – nie przesuwamy etapów
       // ale PID_SET zostaje na ostatnim kroku
@@ -367,40 +1566,104 @@ void controlLoop() {
     // tryb dynamiczny albo brak profilu – licznik etapu zerowy
     PROFILE_ELAPSED_SEC = 0;
     PROFILE_REMAIN_SEC  = 0;
+    PROFILE_ETA_SEC     = 0;
   }
 
   // PID – pracuje tylko gdy mamy sensowny pomiar
   if (!SENSOR_OK) {
-    PID_OUT = 0.0;
+    PID_OUT   = 0.0;
+    PID_FF    = 0.0;
+    PID_PRED  = 0.0;
+    g_dutyQ16 = 0;
+    CASCADE_SP = NAN;
+  } else if (CFG.mode == MODE_AUTOTUNE) {
+    CASCADE_SP = NAN;
+    autotuneTick(now);
   } else {
-#if USE_QUICKPID
-    PIDCTL.Compute();
+    // kaskada: zadana PIDCTL z pętli na wyrobie; wejście / wyjście z kaskady bez uderzenia
+    const double innerSp = cascadeSetpoint(now);
+    if (isfinite(innerSp) != isfinite(CASCADE_SP)) {
+      CASCADE_SP = innerSp;
+      pidBumpless(g_dutyQ16);
+    }
+    CASCADE_SP = innerSp;
+    const q16_t spQ = q16FromDouble(isfinite(CASCADE_SP) ? CASCADE_SP : PID_SET);
+    g_ffQ16 = feedForwardCompute(spQ, profileRateMph());
+#if USE_FIXEDPID
+    gainScheduleApply(g_kilnQ16);
+    // PID dostaje przesunięte limity, więc PID + FF zawsze mieści się w 0..limit mocy
+    // (całka nie nabija się ponad to, co FF już daje)
+    PIDCTL.setOutputLimits(-g_ffQ16, g_dutyMaxQ16 - g_ffQ16);
+    q16_t out;
+    const q16_t pred = SMITH.correction();
+    // D z nachylenia estymatora (+ zmiana korekty Smitha – D widzi to samo wejście co P)
+    if (CFG.pid.kalman && TEMPEST.valid()) PIDCTL.setInputRate(TEMPEST.rate() + SMITH.correctionRate());
+    else                                   PIDCTL.clearInputRate();
+    const uint32_t pidStart = ESP.getCycleCount();
+    if (PIDCTL.compute(now, g_kilnQ16 + pred, spQ, out)) {
+      pidCyclesNote(pidStart);
+      g_dutyQ16 = out + g_ffQ16;
+      PID_OUT   = q16ToDouble(g_dutyQ16);
+      PID_FF    = q16ToDouble(g_ffQ16);
+      PID_PRED  = q16ToDouble(pred);
+      loopMonitorStep(now, spQ);
+    }
+#elif USE_QUICKPID
+    // biblioteki mają stałe limity 0..100 (PID_OUT bez FF) – sumę tylko obcinamy
+    const uint32_t pidStart = ESP.getCycleCount();
+    const bool computed = PIDCTL.Compute();
+    if (computed) pidCyclesNote(pidStart);
+    g_dutyQ16 = min(q16FromDouble(PID_OUT) + g_ffQ16, g_dutyMaxQ16);
+    if (computed) loopMonitorStep(now, spQ);
+    PID_FF    = q16ToDouble(g_ffQ16);
 #else
-    PIDCTL.Compute();
+    const uint32_t pidStart = ESP.getCycleCount();
+    if (PIDCTL.Compute()) {
+      pidCyclesNote(pidStart);
+      g_dutyQ16 = min(q16FromDouble(PID_OUT) + g_ffQ16, g_dutyMaxQ16);
+      loopMonitorStep(now, spQ);
+    }
+    PID_FF    = q16ToDouble(g_ffQ16);
 #endif
   }
 
+  // model (identyfikacja, predyktor) – wypełnienie faktycznie podane na grzałki (0 gdy nie grzejemy)
+  const q16_t appliedQ = (RUN_ACTIVE && !SAFETY_TRIP) ? g_dutyQ16 : 0;
+  SMITH.update(now, appliedQ);
+  if (PLANTID.sample(now, KILN_TEMP, q16ToDouble(appliedQ)) && CFG.modelOnline) modelApply();
+
   // sterowanie SSR
   windowDrive(now);
 
   // próbkowanie (do CSV/wykresu web)
   updateSamples(now);
+  checkpointTick(now);
+
+  // benchmark: cykle CPU na jeden tick sterowania
+  CTRL_TICK_CYCLES = ESP.getCycleCount() - tickStartCycles;
+  if (CTRL_TICK_CYCLES > CTRL_TICK_CYCLES_MAX) CTRL_TICK_CYCLES_MAX = CTRL_TICK_CYCLES;
+  ctrlWatchdogFeed(now);
 }
 
 
 // eksport bufora próbek jako CSV (dla /export)
 void buildSamplesCSV(String& out) {
   out.reserve(64 * (S_LEN + 4));
-  out  = F("rev,tempC,out,heat\n");
+  out  = F("rev,ms,tempC,out,heat,wh,teqC\n");
   for (uint16_t i = 0; i < S_LEN; i++) {
     const Sample& s = SAMPLES[i];
     out += String((uint32_t)s.rev); out += ',';
+    out += String((uint32_t)s.ms);  out += ',';
     if (isfinite(s.temp)) out += String(s.temp, 2);
     else                  out += F("NaN");
     out += ',';
     out += String(s.out, 1);
     out += ',';
     out += String((uint16_t)s.heat);
+    out += ',';
+    out += String((uint32_t)s.wh);
+    out += ',';
+    out += String((uint16_t)s.teq);
     out += '\n';
   }
 }
@@ -408,33 +1671,105 @@ void buildSamplesCSV(String& out) {
 // ────────────────────────────────────────────────────────────────────────────────
 // PROFIL – implementacja applyProfileFromJson (web_config.cpp)
 // ────────────────────────────────────────────────────────────────────────────────
-bool applyProfileFromJson(const JsonArray& arr) {
-  uint8_t n = 0;
-  for (JsonObject s : arr) {
-    if (n >= 8) break;
-    double   t    = s["targetC"] | NAN;
-    uint32_t hold = s["holdSec"] | 0UL;
-    if (!isfinite(t)) continue;
+static bool profileLoaded();
+
+bool profileStepFromJson(JsonObject s, ProfileStep& out) {
+  const double t = s["targetC"] | NAN;
+  if (!isfinite(t)) return false;
+  const uint32_t up   = s["rampCph"] | 0UL;
+  const uint32_t down = s["rampDownCph"] | 0UL;
+  const uint32_t band = s["bandC"] | 0UL;
+  const uint32_t wait = s["maxWaitMin"] | 0UL;
+  const int8_t   cone = coneFromName(s["cone"] | "");
+
+  out.targetC     = (float)t;
+  out.holdSec     = s["holdSec"] | 0UL;
+  out.rampCph     = (uint16_t)(up   > 9999UL ? 9999UL : up);
+  out.rampDownCph = (uint16_t)(down > 9999UL ? 9999UL : down);
+  out.maxWaitMin  = (uint16_t)(wait > 65535UL ? 65535UL : wait);
+  out.bandC       = (uint8_t)(band > 255UL ? 255UL : band);
+  out.cone        = (uint8_t)(cone + 1);   // nieznany / brak → 0
+  return true;
+}
+
+bool profileJsonForEach(Stream& in, ProfileJsonStepFn fn, void* ctx) {
+  if (!in.find("\"steps\"") || !in.find("[")) return false;
+
+  StaticJsonDocument<256> d;   // jeden krok naraz
+  do {
+    // pusta tablica: po '[' od razu ']'
+    int c;
+    while ((c = in.peek()) == ' ' || c == '\n' || c == '\r' || c == '\t') in.read();
+    if (c == ']') { in.read(); return true; }
+
+    if (deserializeJson(d, in)) return false;
+    if (!fn(d.as<JsonObject>(), ctx)) return false;
+  } while (in.findUntil(",", "]"));
+  return true;
+}
 
-    PROFILE[n].targetC = t;
-    PROFILE[n].holdSec = hold;
-    n++;
+// dopisuje krok do PROFILE[], dopóki profil mieści się w puli segmentów
+static bool profileAppendStep(JsonObject s, void* ctx) {
+  uint8_t& segs = *(uint8_t*)ctx;
+  ProfileStep st;
+  if (!profileStepFromJson(s, st)) return true;   // krok bez temperatury – pomijamy
+  if (PROFILE_LEN >= PROFILE_MAX_STEPS || segs + profileStepSegs(st) > PLAN_MAX_SEGS) {
+    Serial.println(F("[CTRL] Profile truncated – segment pool full"));
+    return false;
   }
+  PROFILE[PROFILE_LEN++] = st;
+  segs += profileStepSegs(st);
+  return true;
+}
+
+bool applyProfileFromJson(Stream& json) {
+  uint8_t segs = 0;
+  PROFILE_LEN = 0;
+  profileJsonForEach(json, profileAppendStep, &segs);
+
+  // plan nominalny (od temperatury pokojowej) – do podglądu i zapisu; na START
+  // kompilujemy go ponownie od rzeczywistej temperatury pieca
+  planCompile(PROFILE_PLAN, PROFILE, PROFILE_LEN, 0, PLAN_NOMINAL_START_MILLI);
+  return profileLoaded();
+}
 
-  PROFILE_LEN    = n;
+// profil + plan wczytane z binarnego zapisu (storage.cpp) – bez parsowania JSON
+bool applyProfileFromStorage() {
+  uint8_t n = 0;
+  if (!loadProfile(PROFILE, PROFILE_MAX_STEPS, n, PROFILE_PLAN) || n == 0) return false;
+  PROFILE_LEN = n;
+  return profileLoaded();
+}
+
+// wspólna końcówka po wczytaniu kroków do PROFILE[] / PROFILE_PLAN
+static bool profileLoaded() {
   PROFILE_ACTIVE = 0;
+  g_planSeg      = 0;
   g_profileStepStartMs = millis();
+  PROFILE_PHASE = PHASE_IDLE;
   PROFILE_ELAPSED_SEC = 0;
-  PROFILE_REMAIN_SEC  = (PROFILE_LEN>0) ? PROFILE[0].holdSec : 0;
+  etaPlanInit();
+  const uint32_t end0 = planStepEndMs(PROFILE_PLAN, 0);
+  PROFILE_REMAIN_SEC  = (PROFILE_LEN>0 && end0 != PLAN_INFINITE) ? end0 / 1000UL : 0;
 
   if (PROFILE_LEN > 0) {
     CFG.mode = MODE_PROFILE;   // po wczytaniu profilu przełącz na tryb PROFIL
     PID_SET  = PROFILE[0].targetC;
     Serial.print(F("[CTRL] Profile loaded, steps="));
     Serial.println(PROFILE_LEN);
+    // w trakcie RUN nowy program rusza od kroku 0 z bieżącej temperatury pieca (jak runStart());
+    // bez tego faza zostaje IDLE przy aktywnym RUN i hold nigdy się nie kończy
+    if (RUN_ACTIVE) {
+      const double fromC = programTempC();
+      g_profileCrc = profileCrc(PROFILE, PROFILE_LEN);
+      profileStartFrom(0, isfinite(fromC) ? fromC : PID_SET);
+      Serial.printf("[CTRL] Run %lu continues with the new profile from %.0f C\n",
+                    (unsigned long)RUN_REV, KILN_TEMP);
+    }
     return true;
   } else {
     CFG.mode = MODE_DYNAMIC;
+    g_profileCrc = 0;
     Serial.println(F("[CTRL] Profile cleared (0 steps)"));
     return false;
   }
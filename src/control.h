@@ -1,45 +1,120 @@
 /***************************************************************************************
  * FILE: src/control.h
- * LAST MODIFIED: 2025-11-14 09:20 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-20 05:20 (Europe/Warsaw)
  ***************************************************************************************/
 #pragma once
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "config.h"
+#include "profile_plan.h"
+#include "autotune.h"
+#include "loop_monitor.h"
+#include "plant_id.h"
+#include "temp_estimator.h"
+#include "ssr_modulator.h"
+#include "safety.h"
+#include "heat_work.h"
 
 
 // ────────────────────────────────────────────────────────────────────────────────
 // Zmienne procesu
 // ────────────────────────────────────────────────────────────────────────────────
 extern double   KILN_TEMP;    // °C
+extern double   KILN_TEMP_EST;  // °C – estymata filtru Kalmana (model + termopara)
+extern double   KILN_RATE_CPH;  // °C/h – nachylenie z estymatora (UI, D w PID)
 extern double   CTRL_TEMP;    // °C – temperatura sterownika (MAX31855 internal)
+extern double   WARE_TEMP;    // °C – termopara przy wyrobie (SPI_CS2), NAN = brak / błąd
+extern double   CASCADE_SP;   // °C – zadana pętli przy grzałkach z kaskady, NAN = kaskada nieaktywna
 extern double   PID_SET;      // °C
-extern double   PID_OUT;      // 0..100 %
+extern double   PID_OUT;      // 0..100 % – wypełnienie SSR (PID + feed-forward; PID_v1/QuickPID: sam PID)
+extern double   PID_FF;       // 0..100 % – w tym część feed-forward z modelu
+extern double   PID_PRED;     // °C – korekta predyktora Smitha dodana do pomiaru dla PID
 
 
 extern bool     RUN_ACTIVE;
 extern bool     SAFETY_TRIP;
+extern uint8_t  SAFETY_REASON;   // SafetyTrip (safety.h) – powód zadziałania nadzoru
 
-extern bool     HEATER_ON;
+extern bool     HEATER_ON;    // włączona co najmniej jedna sekcja grzałek
+extern uint32_t SSR_SWITCHES; // przełączenia SSR od startu (suma po sekcjach)
+extern uint8_t  SSR_BANKS;        // sekcje grzałek z przypisanym pinem (SSR, SSR2, SSR3)
+extern uint8_t  SSR_BANKS_ON;     // sekcje włączone w tej chwili
+extern uint8_t  SSR_BANKS_MAX_ON; // limit mocy chwilowej (CFG.heat) – najwięcej sekcji naraz
 extern bool     SENSOR_OK;
 
 extern uint8_t  PROFILE_ACTIVE;
 extern uint8_t  PROFILE_LEN;
 extern uint32_t RUN_REV;
 
+// praca cieplna RUN (heat_work.h): temperatura ekwiwalentna rampy 60 °C/h i najwyższy
+// dojrzały stożek (-1 = żaden); liczona tylko w trakcie RUN, zeruje ją runStart()
+extern int32_t  HEAT_TEQ_MILLI;
+extern int8_t   HEAT_CONE;
+
+// benchmark – cykle CPU ostatniego controlLoop() i maksimum od startu
+extern uint32_t CTRL_TICK_CYCLES;
+extern uint32_t CTRL_TICK_CYCLES_MAX;
+// benchmark – cykle CPU samego kroku PID (compute()) i maksimum od startu
+extern uint32_t CTRL_PID_CYCLES;
+extern uint32_t CTRL_PID_CYCLES_MAX;
+// watchdog sterowania (timer1 – zajęty przez control.cpp: bez tone() / analogWrite() / Servo):
+// ticki ponad termin, zagłodzenia (grzałki zgaszone z ISR); seria ticków ponad termin → restart
+extern uint16_t CTRL_TICK_OVERRUNS;
+extern uint16_t CTRL_STARVE_N;
+extern uint32_t CTRL_STARVE_MAX_MS;   // najdłuższa przerwa między tickami w terminie
+// ramki akwizycji odrzucone przy pełnej kolejce (pętla stała dłużej niż ~4 s)
+extern uint32_t THERMO_Q_DROPPED;
+
 // ────────────────────────────────────────────────────────────────────────────────
 // PROFIL – kroki + czasy etapu
 // ────────────────────────────────────────────────────────────────────────────────
+// upakowane do 16 B – pula kroków jest statyczna, rozmiar jak pula segmentów planu
 struct ProfileStep {
-  double   targetC;   // zadana temperatura
-  uint32_t holdSec;   // czas trwania etapu (sekundy, 0 = nieskończoność)
+  float    targetC;      // zadana temperatura
+  uint32_t holdSec;      // wytrzymanie po zakończeniu rampy (sekundy, 0 = nieskończoność)
+  uint16_t rampCph;      // narost zadanej przy grzaniu [°C/h], 0 = skok
+  uint16_t rampDownCph;  // spadek zadanej przy studzeniu [°C/h], 0 = skok; PID dogrzewa, żeby piec nie
+                         // stygł szybciej, a wolniej stygnący piec wstrzymuje rampę
+  uint16_t maxWaitMin;   // maks. czekanie na wejście w pasmo [min], potem hold i tak startuje (0 = bez limitu)
+  uint8_t  bandC;        // gwarantowane wytrzymanie: hold liczy się dopiero w ±bandC od targetC (0 = od końca rampy)
+  uint8_t  cone;         // koniec holdu po pracy cieplnej stożka: 0 = brak, inaczej indeks stożka + 1;
+                         // holdSec zostaje górną granicą (0 = czekaj tylko na stożek)
 };
 
-extern ProfileStep PROFILE[8];
+// krok zajmuje 1 segment planu (hold) albo 2 (rampa + hold) – profil musi się zmieścić w puli
+static const uint8_t PROFILE_MAX_STEPS = PLAN_MAX_SEGS;
+
+inline uint8_t profileStepSegs(const ProfileStep& s) {
+  return (s.rampCph || s.rampDownCph) ? 2 : 1;
+}
+
+// faza bieżącego etapu (PROFILE_PHASE)
+enum ProfilePhase : uint8_t {
+  PHASE_IDLE = 0,   // brak RUN
+  PHASE_RAMP = 1,   // generator zadanej w trakcie rampy
+  PHASE_WAIT = 2,   // zadana osiągnięta, piec jeszcze poza pasmem – hold wstrzymany
+  PHASE_HOLD = 3    // liczy się czas wytrzymania
+};
 
-// czas etapu (w sekundach): ile minęło / ile zostało
+extern ProfileStep PROFILE[PROFILE_MAX_STEPS];
+
+// czas etapu (w sekundach, rampa + wytrzymanie): ile minęło / ile zostało
 extern uint32_t PROFILE_ELAPSED_SEC;
 extern uint32_t PROFILE_REMAIN_SEC;
+extern uint8_t  PROFILE_PHASE;   // ProfilePhase
+// rampa studzenia wstrzymana – piec stygnie sam wolniej, niż zadaje rampDownCph
+extern bool     PROFILE_COOL_LAG;
+
+// do końca całego programu [s]: oś planu + czekanie na pasmo tam, gdzie piec nie nadąży
+// za rampą (model); przed startem – cały program. PROFILE_ETA_UNKNOWN: hold bez końca
+// albo pasmo nieosiągalne bez limitu czekania
+static const uint32_t PROFILE_ETA_UNKNOWN = 0xFFFFFFFFUL;
+extern uint32_t PROFILE_ETA_SEC;
+
+const char* profilePhaseName(uint8_t phase);   // "idle" / "ramp" / "wait" / "hold"
+
+// skompilowany profil (profile_plan.h) – przebudowywany przy wczytaniu, START i skoku kroku
+extern ProfilePlan PROFILE_PLAN;
 
 // ────────────────────────────────────────────────────────────────────────────────
 // API sterowania
@@ -50,12 +125,59 @@ void controlLoop();
 void runStart();
 void runStop();
 
-// Profil z JSON (web_config.cpp → control.cpp)
-bool applyProfileFromJson(const JsonArray& arr);
+// Profil z JSON (web_config.cpp → control.cpp) – czytany strumieniowo krok po kroku
+// z tablicy "steps", więc rozmiar pliku/ciała HTTP nie wymaga dużego dokumentu na stosie
+bool applyProfileFromJson(Stream& json);
+
+// iteracja po obiektach tablicy "steps" (mały dokument na krok); fn zwraca false = przerwij.
+// false gdy brak "steps", zły JSON albo fn przerwał
+typedef bool (*ProfileJsonStepFn)(JsonObject step, void* ctx);
+bool profileJsonForEach(Stream& json, ProfileJsonStepFn fn, void* ctx);
+
+// krok z obiektu JSON (przycięte zakresy); false gdy brak targetC
+bool profileStepFromJson(JsonObject s, ProfileStep& out);
+
+// Profil ze skompilowanego zapisu binarnego (storage.cpp) – szybki start bez JSON
+bool applyProfileFromStorage();
 
 // Ręczne przełączanie kroków (webserver: /profile/next, /profile/prev)
 void profileNextStep();
 void profilePrevStep();
 
+// Nastawy z CFG.pid / CFG.model ponownie do regulatora (po zmianie konfiguracji): też sekcje
+// SSR, nadzór, kaskada; zeruje adaptację. autotuneApply() przeładowuje tylko nastawy PID
+void pidApplyConfig();
+
+// potwierdzenie zadziałania nadzoru (POST /safety/ack) – jeśli przyczyna trwa, zadziała znowu;
+// /start i autotune odmawiają, dopóki SAFETY_TRIP nie zostanie potwierdzony
+void safetyReset();
+
+// Autotune (MODE_AUTOTUNE): eksperyment przekaźnikowy wokół spC z histerezą hystC;
+// false gdy nie można wystartować (trip, brak czujnika, już trwa)
+bool autotuneStart(double spC, double hystC);
+// wynik (AT_DONE) → CFG.pid (i punkt harmonogramu, jeśli jest) + cfgSave()
+bool autotuneApply();
+const RelayAutotune& autotuneInfo();
+
+// Nadzór pętli (loop_monitor.h) i adaptacja nastaw (CFG.pid.adapt): mnożniki Kp/Ki
+// względem nastaw z konfiguracji, w granicach 0.5..1.5; tylko w RAM
+extern float    LOOP_KP_MUL;
+extern float    LOOP_KI_MUL;
+extern uint16_t LOOP_ADAPT_N;   // liczba korekt od startu / zmiany konfiguracji
+const LoopMonitor& loopMonitorInfo();
+
+// Model obiektu identyfikowany w locie (plant_id.h)
+const PlantIdentifier& plantIdInfo();
+// model używany przez FF / autotune / ETA: zidentyfikowany albo ręczny z CFG.model
+const PlantModel& plantModelActive();
+bool plantModelSave();    // zidentyfikowany → CFG.model + cfgSave(); false gdy niewiarygodny
+void plantModelReset();   // identyfikacja od zera (np. po wymianie grzałek)
+
+// energia grzałek z faktycznego czasu włączenia SSR × CFG.heat.bankW (0 W → 0 Wh);
+// bieżący RUN albo ostatni zakończony – do porównań programów i starzenia się grzałek
+uint32_t energyRunWh();
+uint32_t energyRunSec();
+uint32_t energyStepWh(uint8_t idx);   // krok profilu (indeks w PROFILE)
+
 // eksport próbek do CSV (dla /export)
 void buildSamplesCSV(String& out);
@@ -0,0 +1,65 @@
+/***************************************************************************************
+ * FILE: src/ctrl_watchdog.h
+ * LAST MODIFIED: 2026-10-20 04:50 (Europe/Warsaw)
+ * PURPOSE: Watchdog sterowania – licznik przerwań od ostatniego ticku controlLoop() w terminie
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+
+// Przerwanie timer1 co ISR_PERIOD_MS liczy do STARVE_TICKS; od tej chwili każde kolejne
+// zgłasza zagłodzenie (ISR gasi piny sekcji). Licznik zeruje tylko feed() ticku zakończonego
+// w terminie – tick ponad termin, nawet zakończony, nie odsuwa wyłączenia: seria ticków
+// po 900 ms to dla grzałek to samo co stojąca pętla. RESTART_MISSES ticków z rzędu ponad
+// termin → restartDue(): pętla trwale za wolna, control.cpp gasi grzałki i restartuje ESP.
+// Bez sprzętu (piny i timer w control.cpp) – testowany natywnie.
+class CtrlWatchdog {
+public:
+  static const uint32_t ISR_PERIOD_MS = 250;  // wspólne z akwizycją MAX31855 (control.cpp)
+  static const uint8_t  STARVE_TICKS  = 4;    // 1 s bez udanego ticku → grzałki OFF
+  static const uint32_t DEADLINE_MS   = 50;   // dłuższy tick nie karmi watchdoga
+  static const uint8_t  RESTART_MISSES = 10;  // ticki z rzędu ponad termin → restart
+
+  void begin(uint32_t nowMs) {
+    _ticks   = 0;
+    _starved = false;
+    _missed  = 0;
+    _fedMs   = nowMs;
+  }
+
+  // z ISR (IRAM) – zawsze wkompilowane w miejscu wywołania, bez skoku do flash;
+  // true → zagłodzony, wywołujący gasi piny
+  __attribute__((always_inline)) inline bool isrTick() {
+    if (_ticks < STARVE_TICKS) { _ticks++; return false; }
+    _starved = true;
+    return true;
+  }
+
+  // koniec ticku sterowania; false – tick ponad termin (licznik bez zmian)
+  bool feed(uint32_t startMs, uint32_t endMs) {
+    if (endMs - startMs > DEADLINE_MS) {
+      if (_missed < 255) _missed++;
+      return false;
+    }
+    _ticks  = 0;
+    _missed = 0;
+    _fedMs  = endMs;
+    return true;
+  }
+
+  // odbiór zgłoszenia ISR (pętla); ISR zgłasza ponownie, dopóki nie przyjdzie feed() w terminie
+  bool takeStarved() {
+    if (!_starved) return false;
+    _starved = false;
+    return true;
+  }
+
+  bool     restartDue() const { return _missed >= RESTART_MISSES; }         // pętla trwale za wolna
+  uint32_t fedMs() const { return _fedMs; }                                   // ostatni tick w terminie
+  uint32_t offMs() const { return _fedMs + STARVE_TICKS * ISR_PERIOD_MS; }    // najwcześniejsze wyłączenie
+
+private:
+  volatile uint8_t _ticks   = 0;       // przerwania od ostatniego karmienia
+  volatile bool    _starved = false;   // ISR zgasił grzałki
+  uint8_t          _missed  = 0;       // ticki ponad termin z rzędu
+  uint32_t         _fedMs   = 0;
+};
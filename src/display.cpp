@@ -1,6 +1,6 @@
 /***************************************************************************************
  * FILE: src/display.cpp
- * LAST MODIFIED: 2025-11-14 10:10 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-19 18:40 (Europe/Warsaw)
  * PURPOSE: OLED UI (SSD1306 128x64) – belka statusu + duża temp + czas kroku + wykres
  ***************************************************************************************/
 #include "display.h"
@@ -305,15 +305,20 @@ void displayLoop(){
     if (cy < OLED_H-8){
       oled.setCursor(2, cy);
 
-      // jeśli tryb profilu – krok + minuty (minęło / zostało)
+      // jeśli tryb profilu – krok + faza (R/W/H) + minuty (minęło / zostało)
       if (CFG.mode == MODE_PROFILE && PROFILE_LEN > 0){
         uint32_t em = PROFILE_ELAPSED_SEC / 60;
         uint32_t rm = PROFILE_REMAIN_SEC / 60;
-        oled.printf("P %u/%u  %lum/%lum",
+        static const char PHASE_CH[] = {' ', 'R', 'W', 'H'};
+        oled.printf("P %u/%u %c %lum/%lum",
                     (unsigned)(PROFILE_ACTIVE+1),
                     (unsigned)PROFILE_LEN,
+                    PHASE_CH[PROFILE_PHASE & 3],
                     (unsigned long)em,
                     (unsigned long)rm);
+      } else if (CFG.mode == MODE_AUTOTUNE){
+        // autotune – liczba pełnych cykli oscylacji
+        oled.printf("AT  cykl %u", (unsigned)autotuneInfo().cycles());
       } else {
         // tryb dynamiczny – tylko czas RUN (minuty)
         if (run){
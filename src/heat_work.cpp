@@ -0,0 +1,147 @@
+/***************************************************************************************
+ * FILE: src/heat_work.cpp
+ * LAST MODIFIED: 2026-10-20 00:40 (Europe/Warsaw)
+ * PURPOSE: Praca cieplna – tabele constexpr i akumulator
+ ***************************************************************************************/
+#include "heat_work.h"
+#include <string.h>
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Stożki Orton – duże stożki, 60 °C/h w ostatnich 100 °C
+// ────────────────────────────────────────────────────────────────────────────────
+
+static const char* const CONE_NAMES[CONE_COUNT] = {
+  "010", "09", "08", "07", "06", "05", "04", "03", "02", "01",
+  "1",   "2",  "3",  "4",  "5",  "6",  "7",  "8",  "9",  "10"
+};
+static constexpr int16_t CONE_C60[CONE_COUNT] = {
+   903,  920,  942,  976,  998, 1031, 1063, 1086, 1102, 1119,
+  1137, 1142, 1152, 1162, 1186, 1222, 1239, 1249, 1260, 1285
+};
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Model – używany tylko w czasie kompilacji
+// ────────────────────────────────────────────────────────────────────────────────
+
+static constexpr double HW_E_K      = 100000.0;       // energia aktywacji / R
+static constexpr double HW_TREF_K   = 1473.15;        // 1200 °C
+static constexpr double HW_RATE_CPS = 60.0 / 3600.0;  // rampa kalibracji [°C/s]
+static constexpr int32_t HW_T0_C    = 700;            // niżej praca pomijalna (< 1e-4 stożka 010)
+static constexpr int32_t HW_STEP_C  = 10;
+static constexpr uint8_t HW_N       = 71;             // 700..1400 °C
+
+// exp() dla constexpr – połowienie argumentu do |x| ≤ 0.5, szereg Taylora, potem kwadraty
+static constexpr double cexp(double x) {
+  int k = 0;
+  while (x > 0.5 || x < -0.5) { x *= 0.5; k++; }
+  double sum = 1.0, term = 1.0;
+  for (int n = 1; n < 20; ++n) {
+    term *= x / n;
+    sum  += term;
+  }
+  while (k-- > 0) sum *= sum;
+  return sum;
+}
+
+// szybkość reakcji względem 1200 °C
+static constexpr double hwRate(double tC) {
+  return cexp(HW_E_K / HW_TREF_K - HW_E_K / (tC + 273.15));
+}
+
+template <size_t N>
+struct HwTable { float v[N]; };
+
+// w(T) co HW_STEP_C – interpolowana liniowo w add()
+static constexpr HwTable<HW_N> makeRateTable() {
+  HwTable<HW_N> t{};
+  for (size_t i = 0; i < HW_N; ++i) t.v[i] = (float)hwRate(HW_T0_C + (double)i * HW_STEP_C);
+  return t;
+}
+
+// W rampy 60 °C/h od HW_T0_C do każdego węzła – całka po 1 °C (trapezy)
+static constexpr HwTable<HW_N> makeCumTable() {
+  HwTable<HW_N> t{};
+  double acc = 0.0;
+  t.v[0] = 0.0f;
+  for (size_t i = 1; i < HW_N; ++i) {
+    const double t0 = HW_T0_C + (double)(i - 1) * HW_STEP_C;
+    for (int s = 0; s < HW_STEP_C; ++s) {
+      acc += 0.5 * (hwRate(t0 + s) + hwRate(t0 + s + 1)) / HW_RATE_CPS;
+    }
+    t.v[i] = (float)acc;
+  }
+  return t;
+}
+
+static constexpr HwTable<HW_N> HW_RATE = makeRateTable();
+static constexpr HwTable<HW_N> HW_CUM  = makeCumTable();
+
+// ────────────────────────────────────────────────────────────────────────────────
+// API
+// ────────────────────────────────────────────────────────────────────────────────
+
+const char* coneName(uint8_t idx) {
+  return idx < CONE_COUNT ? CONE_NAMES[idx] : "";
+}
+
+int8_t coneFromName(const char* s) {
+  if (!s) return -1;
+  for (uint8_t i = 0; i < CONE_COUNT; i++) {
+    if (!strcmp(s, CONE_NAMES[i])) return (int8_t)i;
+  }
+  return -1;
+}
+
+int32_t coneTempMilli(uint8_t idx) {
+  return idx < CONE_COUNT ? (int32_t)CONE_C60[idx] * 1000 : 0;
+}
+
+void HeatWork::reset() {
+  _w    = 0;
+  _i    = 0;
+  _teq  = 0;
+  _cone = -1;
+}
+
+void HeatWork::restore(int32_t teqMilli) {
+  reset();
+  if (teqMilli <= HW_T0_C * 1000) return;
+  const int32_t  u = teqMilli - HW_T0_C * 1000;
+  const uint32_t i = (uint32_t)u / (HW_STEP_C * 1000);
+  if (i >= HW_N - 1) {
+    _w = HW_CUM.v[HW_N - 1];
+  } else {
+    const double f = (u - (int32_t)i * HW_STEP_C * 1000) / (HW_STEP_C * 1000.0);
+    _w = HW_CUM.v[i] + (HW_CUM.v[i + 1] - HW_CUM.v[i]) * f;
+  }
+  settle();
+}
+
+void HeatWork::add(int32_t tempMilli, uint32_t dtMs) {
+  if (tempMilli <= HW_T0_C * 1000 || dtMs == 0) return;
+  const int32_t u  = tempMilli - HW_T0_C * 1000;
+  uint32_t      i  = (uint32_t)u / (HW_STEP_C * 1000);
+  float         w;
+  if (i >= HW_N - 1) {
+    w = HW_RATE.v[HW_N - 1];   // powyżej 1400 °C – jak 1400 (i tak poza stożkami)
+  } else {
+    const float f = (u - (int32_t)i * HW_STEP_C * 1000) / (HW_STEP_C * 1000.0f);
+    w = HW_RATE.v[i] + (HW_RATE.v[i + 1] - HW_RATE.v[i]) * f;
+  }
+  _w += (double)w * dtMs / 1000.0;
+  settle();
+}
+
+void HeatWork::settle() {
+  while (_i + 1 < HW_N && _w >= HW_CUM.v[_i + 1]) _i++;
+  if (_w <= 0) {
+    _teq = 0;
+  } else if (_i + 1 >= HW_N) {
+    _teq = (HW_T0_C + (int32_t)(HW_N - 1) * HW_STEP_C) * 1000;
+  } else {
+    const double span = HW_CUM.v[_i + 1] - HW_CUM.v[_i];
+    const double f    = span > 0 ? (_w - HW_CUM.v[_i]) / span : 0.0;
+    _teq = (HW_T0_C + (int32_t)_i * HW_STEP_C) * 1000 + (int32_t)(f * HW_STEP_C * 1000.0);
+  }
+  while (_cone + 1 < CONE_COUNT && _teq >= (int32_t)CONE_C60[_cone + 1] * 1000) _cone++;
+}
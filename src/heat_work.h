@@ -0,0 +1,46 @@
+/***************************************************************************************
+ * FILE: src/heat_work.h
+ * LAST MODIFIED: 2026-10-20 00:40 (Europe/Warsaw)
+ * PURPOSE: Praca cieplna – całka czas–temperatura w ekwiwalencie stożków Orton
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+
+// Mięknięcie stożka to reakcja aktywowana termicznie, więc liczy się nie sama temperatura,
+// ale praca cieplna W = ∫ exp(E/Tref − E/T) dt (Arrhenius, T w K, E = 100 000 K,
+// Tref = 1200 °C → W w sekundach „ekwiwalentu 1200 °C”).
+// Kalibracja: tabela Orton (duże stożki, 60 °C/h w ostatnich 100 °C) – stożek X jest
+// dojrzały, gdy W ≥ W rampy 60 °C/h do jego temperatury z tabeli. Rampa 150 °C/h daje
+// wtedy stożki o 12–22 °C wyżej – tyle, o ile różnią się kolumny 60 i 150 °C/h tabeli.
+// Wynik jako temperatura ekwiwalentna Teq: do ilu °C trzeba by dojść rampą 60 °C/h, żeby
+// wykonać tę samą pracę – porównanie ze stożkiem to porównanie z tabelą.
+// W runtime tylko tabele constexpr co 10 °C (700..1400 °C) z interpolacją, bez exp();
+// add() O(1) – indeks w tabeli skumulowanej tylko rośnie, bo W nie maleje.
+
+static const uint8_t CONE_COUNT = 20;   // 010 .. 10
+
+const char* coneName(uint8_t idx);         // 0 → "010", CONE_COUNT-1 → "10"
+int8_t      coneFromName(const char* s);   // "06" / "6" / "010"; -1 gdy nieznany
+int32_t     coneTempMilli(uint8_t idx);    // temperatura z tabeli (60 °C/h) [m°C]
+
+class HeatWork {
+public:
+  void reset();
+  void restore(int32_t teqMilli);   // po wznowieniu RUN (checkpoint trzyma Teq)
+
+  // jedna ramka pomiaru: temperatura pieca i czas od poprzedniej ramki
+  void add(int32_t tempMilli, uint32_t dtMs);
+
+  int32_t teqMilli() const { return _teq; }    // 0 = jeszcze bez pracy (poniżej 700 °C)
+  int8_t  cone()     const { return _cone; }   // najwyższy dojrzały stożek, -1 = żaden
+  bool    reached(uint8_t idx) const { return _cone >= (int8_t)idx; }
+  double  workSec()  const { return _w; }
+
+private:
+  void settle();
+
+  double   _w    = 0;    // praca [s ekwiwalentu 1200 °C]
+  uint8_t  _i    = 0;    // przedział tabeli skumulowanej, w którym leży _w
+  int32_t  _teq  = 0;
+  int8_t   _cone = -1;
+};
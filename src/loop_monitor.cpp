@@ -0,0 +1,104 @@
+/***************************************************************************************
+ * FILE: src/loop_monitor.cpp
+ * LAST MODIFIED: 2026-10-19 19:10 (Europe/Warsaw)
+ * PURPOSE: Nadzór jakości regulacji – implementacja
+ ***************************************************************************************/
+#include "loop_monitor.h"
+
+static const q16_t    LM_DEADBAND   = Q16_ONE / 2;          // ±0.5 °C – szum termopary
+static const q16_t    LM_AMP_MIN    = 2 * Q16_ONE;          // mniejsze wahania nie przeszkadzają
+static const q16_t    LM_SUSTAIN    = (q16_t)(0.7 * 65536); // szczyt / poprzedni tego znaku
+static const uint32_t LM_HALF_MIN   = 30000UL;              // krótsze półokresy = drganie, nie cykl
+static const uint32_t LM_SLOW_MS    = 30UL * 60000UL;
+static const q16_t    LM_SLOW_ERR   = 3 * Q16_ONE;
+
+const char* loopHealthName(uint8_t h) {
+  switch (h) {
+    case LOOP_OSCILLATING: return "oscillating";
+    case LOOP_SLUGGISH:    return "sluggish";
+    default:               return "ok";
+  }
+}
+
+void LoopMonitor::reset(uint32_t nowMs) {
+  _n       = 0;
+  _sign    = 0;
+  _curPeak = 0;
+  _tCross  = nowMs;
+  _tSlow   = nowMs;
+  _sumAbs  = 0;
+  _nAbs    = 0;
+}
+
+void LoopMonitor::pushHalf(q16_t peak, uint32_t durMs) {
+  if (_n == HALVES) {
+    for (uint8_t i = 1; i < HALVES; i++) { _peak[i - 1] = _peak[i]; _dur[i - 1] = _dur[i]; }
+    _n--;
+  }
+  _peak[_n] = peak;
+  _dur[_n]  = durMs;
+  _n++;
+}
+
+bool LoopMonitor::update(uint32_t nowMs, q16_t errQ, bool steady, bool saturated) {
+  // rampa / zmiana zadanej / stop – uchyb nic nie mówi o nastawach
+  if (!steady) { reset(nowMs); return false; }
+
+  const q16_t a = errQ < 0 ? -errQ : errQ;
+  if (a > _curPeak) _curPeak = a;
+
+  if (saturated) { _tSlow = nowMs; _sumAbs = 0; _nAbs = 0; }
+  _sumAbs += a;
+  _nAbs++;
+  _st.iaeQ = (q16_t)(_sumAbs / _nAbs);
+
+  const int8_t s = (errQ > LM_DEADBAND) ? 1 : (errQ < -LM_DEADBAND) ? -1 : 0;
+  if (s != 0 && s != _sign) {
+    if (_sign != 0) {
+      if (nowMs - _tCross >= LM_HALF_MIN) pushHalf(_curPeak, nowMs - _tCross);
+      else                                _n = 0;   // drganie wokół zadanej – od nowa
+    }
+    _sign    = s;
+    _tCross  = nowMs;
+    _curPeak = a;
+    _tSlow   = nowMs;
+    _sumAbs  = 0;
+    _nAbs    = 0;
+
+    if (_n == HALVES) {
+      q16_t minPeak = _peak[0];
+      int64_t sum = 0;
+      for (uint8_t i = 0; i < HALVES; i++) {
+        if (_peak[i] < minPeak) minPeak = _peak[i];
+        sum += _peak[i];
+      }
+      // półokresy naprzemienne: porównujemy szczyty tego samego znaku
+      const bool sustained = (int64_t)_peak[2] << 16 >= (int64_t)LM_SUSTAIN * _peak[0] &&
+                             (int64_t)_peak[3] << 16 >= (int64_t)LM_SUSTAIN * _peak[1];
+      _st.ampQ     = (q16_t)(sum / HALVES);
+      _st.periodMs = _dur[2] + _dur[3];
+      _n = 0;
+      if (minPeak >= LM_AMP_MIN && sustained) {
+        _health = LOOP_OSCILLATING;
+        return true;
+      }
+      _health = LOOP_OK;   // oscylacja gasnąca – nastawy w porządku
+      _st.periodMs = 0;
+    }
+    return false;
+  }
+
+  // długo po jednej stronie zadanej bez nasycenia wyjścia
+  if (nowMs - _tSlow >= LM_SLOW_MS) {
+    const bool slow = _st.iaeQ >= LM_SLOW_ERR;
+    _tSlow  = nowMs;
+    _sumAbs = 0;
+    _nAbs   = 0;
+    if (slow) {
+      _health = LOOP_SLUGGISH;
+      return true;
+    }
+    if (_health == LOOP_SLUGGISH) _health = LOOP_OK;
+  }
+  return false;
+}
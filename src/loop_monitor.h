@@ -0,0 +1,62 @@
+/***************************************************************************************
+ * FILE: src/loop_monitor.h
+ * LAST MODIFIED: 2026-10-19 19:10 (Europe/Warsaw)
+ * PURPOSE: Nadzór jakości regulacji – wykrywanie oscylacji i zbyt wolnej odpowiedzi
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+#include "pid_fixed.h"
+
+// Ocena na uchybie przy stałej zadanej (hold / tryb dynamiczny, bez rampy):
+//  • przejścia przez zero z martwą strefą ±0.5 °C dzielą przebieg na półokresy,
+//    dla każdego zapamiętujemy szczyt |e| i długość;
+//  • OSCILLATING – 4 kolejne półokresy z amplitudą ≥ 2 °C, które nie gasną
+//    (szczyt tego samego znaku ≥ 70 % poprzedniego) → cykl graniczny;
+//  • SLUGGISH – 30 min bez przejścia przez zero przy średnim |e| ≥ 3 °C, a wyjście
+//    nie było w nasyceniu (wtedy brakuje mocy, nie nastaw).
+// Po werdykcie zbieranie zaczyna się od nowa – kolejna korekta dopiero na świeżych danych.
+
+enum LoopHealth : uint8_t {
+  LOOP_OK          = 0,
+  LOOP_OSCILLATING = 1,
+  LOOP_SLUGGISH    = 2
+};
+
+const char* loopHealthName(uint8_t h);
+
+struct LoopStats {
+  q16_t    ampQ     = 0;   // średni szczyt |e| ostatnich półokresów [°C]
+  uint32_t periodMs = 0;   // okres (dwa ostatnie półokresy), 0 = nie oscyluje
+  q16_t    iaeQ     = 0;   // średnie |e| od ostatniego przejścia przez zero [°C]
+};
+
+class LoopMonitor {
+public:
+  void reset(uint32_t nowMs);
+
+  // wywołanie po każdym kroku PID; true gdy zapadł werdykt OSCILLATING / SLUGGISH
+  bool update(uint32_t nowMs, q16_t errQ, bool steady, bool saturated);
+
+  LoopHealth       health() const { return _health; }
+  const LoopStats& stats()  const { return _st; }
+
+private:
+  static const uint8_t HALVES = 4;
+
+  void pushHalf(q16_t peak, uint32_t durMs);
+
+  LoopHealth _health = LOOP_OK;
+  LoopStats  _st;
+
+  q16_t    _peak[HALVES];
+  uint32_t _dur[HALVES];
+  uint8_t  _n = 0;             // zebrane półokresy
+
+  int8_t   _sign = 0;          // znak uchybu poza martwą strefą, 0 = jeszcze nie wiadomo
+  q16_t    _curPeak = 0;
+  uint32_t _tCross = 0;        // ostatnie przejście (albo reset)
+
+  uint32_t _tSlow = 0;         // początek odcinka bez nasycenia (ocena SLUGGISH)
+  int64_t  _sumAbs = 0;
+  uint32_t _nAbs = 0;
+};
@@ -1,6 +1,6 @@
 /***************************************************************************************
  * FILE: src/main.cpp
- * LAST MODIFIED: 2025-11-15 01:20 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-19 22:40 (Europe/Warsaw)
  * PURPOSE: Arduino entry points – uruchamia config + control + web + OLED
  ***************************************************************************************/
 #include <Arduino.h>
@@ -9,6 +9,7 @@
 #include "webserver.h"
 #include "web_config.h"
 #include "display.h"
+#include "storage.h"   // checkpointLoop() – zapis stanu RUN do flash poza tickiem
 #include <LittleFS.h>
 #include <ESP8266WiFi.h>
 
@@ -50,6 +51,7 @@ void setup() {
 
 void loop() {
   controlLoop();      // pomiary, PID, SSR okno, safety
+  checkpointLoop();   // odroczony zapis checkpointu RUN do flash (wznowienie po zaniku)
   webserverLoop();    // obsługa HTTP
   displayLoop();      // odświeżanie ekranu (co ~500 ms)
 
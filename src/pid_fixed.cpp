@@ -0,0 +1,133 @@
+/***************************************************************************************
+ * FILE: src/pid_fixed.cpp
+ * LAST MODIFIED: 2026-10-20 05:10 (Europe/Warsaw)
+ * PURPOSE: PID stałoprzecinkowy (Q16.16) – implementacja
+ ***************************************************************************************/
+#include "pid_fixed.h"
+#include <math.h>
+
+static inline q16_t clampQ(int64_t v, q16_t lo, q16_t hi) {
+  if (v < lo) return lo;
+  if (v > hi) return hi;
+  return (q16_t)v;
+}
+
+// iloczyn dwóch Q16.16 → Q16.16, zaokrąglony do najbliższej – samo przesunięcie obcina w dół
+// i w całce (ki·e co próbkę) zbiera się dryf −0.5 LSB na krok (~0.5 % na 2 h przy 10 Hz)
+static inline int64_t qmul(q16_t a, q16_t b) {
+  return ((int64_t)a * (int64_t)b + 0x8000) >> 16;
+}
+
+void FixedPID::setTunings(double kp, double ki, double kd) {
+  if (kp < 0 || ki < 0 || kd < 0) return;   // PID_v1 też ignoruje ujemne
+  _dispKp = kp; _dispKi = ki; _dispKd = kd;
+  rescale();
+}
+
+void FixedPID::setShaping(double spWeight, double dFilterN, double awTrackSec) {
+  if (!(spWeight >= 0.0 && spWeight <= 1.0)) spWeight = 1.0;
+  if (!(dFilterN >= 0.0))   dFilterN   = 0.0;
+  if (!(awTrackSec >= 0.0)) awTrackSec = 0.0;
+  _spW = spWeight; _dN = dFilterN; _awTt = awTrackSec;
+  rescale();
+}
+
+void FixedPID::setSampleTime(uint32_t ms) {
+  if (ms == 0) return;
+  _sampleMs = ms;
+  rescale();
+}
+
+void FixedPID::scaleGains(double kp, double ki, double kd,
+                          q16_t& qKp, q16_t& qKiTs, q16_t& qKdTs) const {
+  const double ts = _sampleMs / 1000.0;
+  qKp   = q16FromDouble(kp);
+  qKiTs = q16FromDouble(ki * ts);
+  qKdTs = q16FromDouble(kd / ts);
+}
+
+void FixedPID::rescale() {
+  const double ts = _sampleMs / 1000.0;
+  scaleGains(_dispKp, _dispKi, _dispKd, _kp, _ki, _kd);
+
+  _spWeight = q16FromDouble(_spW);
+  _dNq      = q16FromDouble(_dN);
+  updateDAlpha();
+
+  // back-calculation: Ts/Tt (≤ 1, inaczej śledzenie przeskakuje)
+  _kt = 0;
+  if (_awTt > 0.0) {
+    _kt = q16FromDouble(ts >= _awTt ? 1.0 : ts / _awTt);
+  }
+}
+
+void FixedPID::setScaledGains(q16_t qKp, q16_t qKiTs, q16_t qKdTs) {
+  _ki = qKiTs;
+  if (qKp == _kp && qKdTs == _kd) return;
+  _kp = qKp;
+  _kd = qKdTs;
+  updateDAlpha();
+}
+
+// filtr D: Tf = Td/N, Td = Kd/Kp → alpha = Tf/(Tf+Ts) = Kd/(Kd + N·Kp·Ts); w postaci
+// przeskalowanej (_kd = Kd/Ts) Ts się skraca: alpha = _kd/(_kd + N·_kp) – jedno dzielenie
+void FixedPID::updateDAlpha() {
+  _dAlpha = 0;
+  if (_dNq <= 0 || _kp <= 0 || _kd <= 0) return;
+  const int64_t den = (int64_t)_kd + qmul(_dNq, _kp);
+  _dAlpha = (q16_t)((((int64_t)_kd << 16) + den / 2) / den);
+}
+
+void FixedPID::setOutputLimits(q16_t lo, q16_t hi) {
+  if (lo >= hi) return;
+  _outMin = lo;
+  _outMax = hi;
+  _sum = clampQ(_sum, _outMin, _outMax);
+}
+
+void FixedPID::initialize(q16_t input, q16_t setpoint, q16_t output) {
+  const int64_t pTerm = qmul(_kp, (q16_t)(qmul(_spWeight, setpoint) - input));
+  int64_t i = (int64_t)output - pTerm;
+  if (i > output) i = output;
+  _sum       = clampQ(i, _outMin, _outMax);
+  _lastInput = input;
+  _dFilt     = 0;
+}
+
+bool FixedPID::compute(uint32_t nowMs, q16_t input, q16_t setpoint, q16_t& output) {
+  // pierwsze wywołanie liczy od razu (PID_v1: lastTime = millis() - SampleTime)
+  if (_started && (nowMs - _lastMs) < _sampleMs) return false;
+  _started = true;
+
+  const q16_t error  = setpoint - input;
+  const q16_t dInput = _useRate ? (q16_t)((int64_t)_rate * (int64_t)_sampleMs / 1000)
+                               : input - _lastInput;
+
+  // D od pomiaru, przez filtr 1. rzędu (alpha = 0 → surowa różnica jak w PID_v1)
+  _dFilt = (q16_t)(qmul(_dAlpha, _dFilt) + qmul(Q16_ONE - _dAlpha, dInput));
+
+  const int64_t pTerm = qmul(_kp, (q16_t)(qmul(_spWeight, setpoint) - input));
+  const int64_t dTerm = -qmul(_kd, _dFilt);
+
+  // całkowanie warunkowe: jeśli wyjście i tak jest w nasyceniu, a uchyb pcha
+  // dalej w tę samą stronę – całki nie ruszamy
+  int64_t sum = (int64_t)_sum + qmul(_ki, error);
+  const int64_t vTry = pTerm + sum + dTerm;
+  if ((vTry > _outMax && error > 0) || (vTry < _outMin && error < 0)) sum = _sum;
+
+  const int64_t v = pTerm + sum + dTerm;
+  output = clampQ(v, _outMin, _outMax);
+
+  // back-calculation: ściągamy całkę o nadwyżkę ponad nasycenie
+  if (_kt > 0 && v != output) {
+    int64_t excess = (int64_t)output - v;
+    if (excess >  INT32_MAX) excess =  INT32_MAX;
+    if (excess < -INT32_MAX) excess = -INT32_MAX;
+    sum += ((int64_t)_kt * excess) >> 16;
+  }
+
+  _sum       = clampQ(sum, _outMin, _outMax);
+  _lastInput = input;
+  _lastMs    = nowMs;
+  return true;
+}
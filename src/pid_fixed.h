@@ -0,0 +1,73 @@
+/***************************************************************************************
+ * FILE: src/pid_fixed.h
+ * LAST MODIFIED: 2026-10-20 05:10 (Europe/Warsaw)
+ * PURPOSE: PID stałoprzecinkowy (Q16.16) – zamiennik PID_v1 bez soft-float double
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+
+// Q16.16: 1.0 = 65536. Temperatury w °C, wyjście w % (100 % = 100 << 16).
+typedef int32_t q16_t;
+
+static const q16_t Q16_ONE = 65536;
+
+inline q16_t q16FromDouble(double v) { return (q16_t)(v * 65536.0 + (v < 0 ? -0.5 : 0.5)); }
+inline double q16ToDouble(q16_t v)   { return v * (1.0 / 65536.0); }
+
+// m°C (wynik tcLinearizeCounts) → Q16.16 °C bez dzielenia: 65.536 ≈ 4294967 / 2^16
+inline q16_t q16FromMilli(int32_t mC) { return (q16_t)(((int64_t)mC * 4294967LL) >> 16); }
+
+// Ta sama semantyka co PID_v1 (br3ttb): D od pomiaru, Ki [1/s] i Kd [s] przeskalowane
+// o czas próbkowania, całka obcinana do limitów wyjścia. Ponadto (v2):
+//  - waga zadanej w członie P (spWeight: 1 = jak PID_v1, <1 = mniejszy kop przy skoku SP),
+//  - filtr 1. rzędu na D (Tf = Td/N, N = dFilterN; 0 = bez filtru),
+//  - anti-windup: całkowanie warunkowe (nie całkujemy w głąb nasycenia) +
+//    opcjonalnie back-calculation ze stałą śledzenia awTrackSec (0 = wyłączone),
+//  - initialize() do bezuderzeniowego przejęcia (start RUN, skok kroku, zmiana trybu).
+// Double pojawia się tylko w setTunings()/setShaping() (rzadko), compute() liczy na int32/int64.
+class FixedPID {
+public:
+  void setTunings(double kp, double ki, double kd);
+  void setShaping(double spWeight, double dFilterN, double awTrackSec);
+  void setSampleTime(uint32_t ms);
+  void setOutputLimits(q16_t lo, q16_t hi);
+
+  // nastawy przeliczone z góry do postaci wewnętrznej (kp, ki·Ts, kd/Ts w Q16.16) –
+  // do harmonogramu nastaw: przeliczenie raz przy konfiguracji (i po setSampleTime()),
+  // w ticku tylko podmiana; alpha filtra D przeliczana, gdy zmieni się kp albo kd
+  void scaleGains(double kp, double ki, double kd, q16_t& qKp, q16_t& qKiTs, q16_t& qKdTs) const;
+  void setScaledGains(q16_t qKp, q16_t qKiTs, q16_t qKdTs);
+
+  // bumpless: całka tak, żeby przy bieżącym pomiarze i zadanej wyjście = output,
+  // ale nie wyżej niż output (po skoku zadanej w dół całka nie „pamięta” dawnej mocy)
+  void initialize(q16_t input, q16_t setpoint, q16_t output);
+
+  // D od zewnętrznej estymaty nachylenia pomiaru [°C/s Q16.16] zamiast różnicy kolejnych
+  // próbek (estymator temperatury); clearInputRate() – z powrotem różnica pomiaru
+  void setInputRate(q16_t perSec) { _rate = perSec; _useRate = true; }
+  void clearInputRate()           { _useRate = false; }
+
+  // true gdy minął czas próbkowania i output został przeliczony
+  bool compute(uint32_t nowMs, q16_t input, q16_t setpoint, q16_t& output);
+
+private:
+  void rescale();
+  void updateDAlpha();
+
+  double   _dispKp = 0, _dispKi = 0, _dispKd = 0;  // nastawy „ludzkie” do przeskalowania
+  double   _spW = 1.0, _dN = 0.0, _awTt = 0.0;
+  q16_t    _kp = 0, _ki = 0, _kd = 0;              // ki·Ts, kd/Ts w Q16.16
+  q16_t    _spWeight = Q16_ONE;                    // b
+  q16_t    _dAlpha = 0;                            // Tf/(Tf+Ts) – 0 = bez filtru
+  q16_t    _dNq = 0;                               // N filtru D w Q16.16
+  q16_t    _kt = 0;                                // Ts/Tt – 0 = bez back-calculation
+  q16_t    _outMin = 0, _outMax = 100 * Q16_ONE;
+  int32_t  _sum = 0;                               // część całkująca (Q16.16 %)
+  q16_t    _dFilt = 0;                             // przefiltrowana zmiana pomiaru
+  q16_t    _lastInput = 0;
+  uint32_t _sampleMs = 100;                        // jak domyślnie w PID_v1
+  uint32_t _lastMs = 0;
+  bool     _started = false;
+  q16_t    _rate = 0;                              // setInputRate()
+  bool     _useRate = false;
+};
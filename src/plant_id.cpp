@@ -0,0 +1,154 @@
+/***************************************************************************************
+ * FILE: src/plant_id.cpp
+ * LAST MODIFIED: 2026-10-20 00:10 (Europe/Warsaw)
+ * PURPOSE: Identyfikacja modelu FOPDT pieca w locie – implementacja
+ ***************************************************************************************/
+#include "plant_id.h"
+#include <math.h>
+
+static const uint8_t PLANT_DELAYS[PLANT_BANK] = { 0, 1, 2, 4, 8, 16, 32, 48 };   // × Ts
+
+static const double RLS_LAMBDA  = 0.999;   // pamięć ~Ts/(1−λ) ≈ 2.8 h
+static const double RLS_P0      = 1000.0;
+static const double RLS_PMAX    = 1e5;     // ślad P ponad to → bez zapominania (brak pobudzenia)
+static const double ERR_LAMBDA  = 0.99;    // wygładzanie błędu predykcji (~17 min)
+static const uint32_t MIN_UPDATES = 60;    // 10 min danych, zanim cokolwiek pokażemy
+
+PlantIdentifier::PlantIdentifier() { reset(); }
+
+void PlantIdentifier::reset() {
+  for (uint8_t i = 0; i < PLANT_BANK; i++) {
+    PlantRls& r = _bank[i];
+    r.delay = PLANT_DELAYS[i];
+    r.th[0] = 0.99; r.th[1] = 0.0; r.th[2] = 0.0;
+    for (uint8_t a = 0; a < 3; a++)
+      for (uint8_t b = 0; b < 3; b++) r.P[a][b] = (a == b) ? RLS_P0 : 0.0;
+    r.err = 0.0;
+  }
+  _uHead = _uLen = 0;
+  _y = NAN;
+  _sumT = _sumU = 0;
+  _nSum = 0;
+  _tStep = millis();
+  _updates = 0;
+  _best = 0;
+  _valid = false;
+  _model = PlantModel();
+}
+
+double PlantIdentifier::rmsC() const {
+  return sqrt(_bank[_best].err) * 100.0;
+}
+
+bool PlantIdentifier::sample(uint32_t nowMs, double tempC, double dutyPct) {
+  if (!isfinite(tempC)) {   // dziura w pomiarze – krok Ts bez danych nie wchodzi do RLS
+    _sumT = _sumU = 0; _nSum = 0; _y = NAN;
+    _tStep = nowMs;
+    return false;
+  }
+  _sumT += tempC;
+  _sumU += dutyPct;
+  _nSum++;
+  if (nowMs - _tStep < PLANT_TS_MS) return false;
+  _tStep += PLANT_TS_MS;
+  if (nowMs - _tStep >= PLANT_TS_MS) _tStep = nowMs;   // pętla stała dłużej – bez nadrabiania
+
+  const double y1 = _sumT / _nSum;
+  const float  u  = (float)(_sumU / _nSum);
+  _sumT = _sumU = 0; _nSum = 0;
+
+  const bool haveY = isfinite(_y);
+  if (haveY) step(y1 / 100.0);
+  _y = y1;
+
+  // historia wypełnienia – u[k] trafia po kroku, bo T[k+1] zależy od u[k−d]
+  _u[_uHead] = u;
+  _uHead = (_uHead + 1) % PLANT_HIST;
+  if (_uLen < PLANT_HIST) _uLen++;
+  return haveY && _valid;
+}
+
+void PlantIdentifier::step(double y1) {
+  const double y = _y / 100.0;
+  for (uint8_t i = 0; i < PLANT_BANK; i++) {
+    PlantRls& r = _bank[i];
+    if (r.delay >= _uLen) continue;   // jeszcze za krótka historia dla tego opóźnienia
+    const double u = _u[(_uHead + PLANT_HIST - 1 - r.delay) % PLANT_HIST] / 100.0;
+    const double phi[3] = { y, u, 1.0 };
+
+    const double e = y1 - (r.th[0] * phi[0] + r.th[1] * phi[1] + r.th[2] * phi[2]);
+    r.err = ERR_LAMBDA * r.err + (1.0 - ERR_LAMBDA) * e * e;
+
+    double pphi[3];
+    for (uint8_t a = 0; a < 3; a++)
+      pphi[a] = r.P[a][0] * phi[0] + r.P[a][1] * phi[1] + r.P[a][2] * phi[2];
+    const double trace = r.P[0][0] + r.P[1][1] + r.P[2][2];
+    const double lam   = (trace > RLS_PMAX) ? 1.0 : RLS_LAMBDA;
+    const double den   = lam + phi[0] * pphi[0] + phi[1] * pphi[1] + phi[2] * pphi[2];
+
+    double k[3];
+    for (uint8_t a = 0; a < 3; a++) {
+      k[a] = pphi[a] / den;
+      r.th[a] += k[a] * e;
+    }
+    // P = (P − k·(Pφ)ᵀ)/λ – P symetryczna, więc φᵀP = (Pφ)ᵀ
+    for (uint8_t a = 0; a < 3; a++)
+      for (uint8_t b = 0; b < 3; b++)
+        r.P[a][b] = (r.P[a][b] - k[a] * pphi[b]) / lam;
+  }
+  _updates++;
+
+  // najlepszy fizycznie sensowny estymator banku
+  _valid = false;
+  if (_updates < MIN_UPDATES) return;
+  PlantModel m;
+  for (uint8_t i = 0; i < PLANT_BANK; i++) {
+    if (_bank[i].delay >= _uLen || !toModel(_bank[i], m)) continue;
+    if (!_valid || _bank[i].err < _bank[_best].err) {
+      _best  = i;
+      _model = m;
+      _valid = true;
+    }
+  }
+}
+
+bool PlantIdentifier::toModel(const PlantRls& r, PlantModel& m) const {
+  const double a = r.th[0], b = r.th[1], c = r.th[2];
+  if (!(a > 0.5 && a < 0.99999) || !(b > 0.0)) return false;
+  const double ts  = PLANT_TS_MS / 1000.0;
+  const double K   = b / (1.0 - a);
+  const double tau = -ts / log(a);
+  const double amb = c * 100.0 / (1.0 - a);
+  if (!(K >= 0.5 && K <= 100.0) || !(tau >= 60.0 && tau <= 100000.0)) return false;
+  if (!(amb > -40.0 && amb < 100.0)) return false;
+  m.K       = (float)K;
+  m.tauSec  = (float)tau;
+  m.deadSec = (float)(r.delay * ts);
+  m.ambC    = (float)amb;
+  return true;
+}
+
+double plantSecondsToReach(const PlantModel& m, double fromC, double toC, double dutyPct) {
+  if (!(m.K > 0.0f && m.tauSec > 0.0f)) return NAN;
+  const double tInf = m.ambC + m.K * dutyPct;   // temperatura ustalona przy tym wypełnieniu
+  const double num  = tInf - fromC;
+  const double den  = tInf - toC;
+  if (num == 0.0 || den == 0.0 || (num > 0) != (den > 0) || fabs(den) > fabs(num)) return NAN;
+  return m.tauSec * log(num / den);
+}
+
+double plantSecondsOnRamp(const PlantModel& m, double fromC, double toC, double rateCph, double dutyPct) {
+  if (!(m.K > 0.0f && m.tauSec > 0.0f)) return NAN;
+  if (toC == fromC) return 0.0;
+  const bool   up   = toC > fromC;
+  const double tInf = up ? m.ambC + m.K * dutyPct : m.ambC;   // w dół – stygnięcie bez grzania
+  if (up ? toC >= tInf : toC <= tInf) return INFINITY;
+  if (!(rateCph > 0.0)) return plantSecondsToReach(m, fromC, toC, up ? dutyPct : 0.0);
+
+  // temperatura, przy której osiągalne nachylenie spada do nachylenia rampy
+  const double lag = rateCph * m.tauSec / 3600.0;
+  const double tc  = up ? tInf - lag : tInf + lag;
+  if (up ? tc >= toC : tc <= toC)     return fabs(toC - fromC) * 3600.0 / rateCph;
+  if (up ? tc <= fromC : tc >= fromC) return plantSecondsToReach(m, fromC, toC, up ? dutyPct : 0.0);
+  return fabs(tc - fromC) * 3600.0 / rateCph + plantSecondsToReach(m, tc, toC, up ? dutyPct : 0.0);
+}
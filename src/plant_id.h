@@ -0,0 +1,70 @@
+/***************************************************************************************
+ * FILE: src/plant_id.h
+ * LAST MODIFIED: 2026-10-20 00:10 (Europe/Warsaw)
+ * PURPOSE: Identyfikacja modelu FOPDT pieca w locie (RLS z zapominaniem)
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Dyskretny FOPDT z krokiem Ts = PLANT_TS_MS (średnie z próbek w kroku):
+//   T[k+1] = a·T[k] + b·u[k−d] + c
+// stąd K = b/(1−a) [°C/%], tau = −Ts/ln(a), Tamb = c/(1−a), theta = d·Ts.
+// Opóźnienia d nie da się wprost wpiąć w RLS, więc liczymy bank estymatorów dla kilku d
+// i bierzemy ten z najmniejszym błędem predykcji (ważonym tak samo jak zapominanie).
+// Pamięć stała: historia wypełnienia + 3×3 macierz P na estymator, krok raz na Ts.
+
+static const uint32_t PLANT_TS_MS   = 10000UL;   // piec jest wolny – 10 s wystarcza
+static const uint8_t  PLANT_BANK    = 8;         // opóźnienia 0..8 min (PLANT_DELAYS)
+static const uint8_t  PLANT_HIST    = 49;        // najdłuższe opóźnienie + 1
+
+struct PlantRls {
+  uint8_t delay = 0;     // d w krokach Ts
+  double  th[3];         // a, b, c (na wartościach /100 – lepsze uwarunkowanie)
+  double  P[3][3];
+  double  err = 0;       // ważony błąd predykcji² [(°C/100)²]
+};
+
+class PlantIdentifier {
+public:
+  PlantIdentifier();
+  void reset();
+
+  // co tick: temperatura pieca i faktyczne wypełnienie SSR [%]; true gdy nowa estymata
+  bool sample(uint32_t nowMs, double tempC, double dutyPct);
+
+  bool              valid()   const { return _valid; }
+  const PlantModel& model()   const { return _model; }   // najlepszy z banku (gdy valid)
+  double            rmsC()    const;                      // błąd predykcji na krok Ts
+  uint32_t          updates() const { return _updates; }
+  uint8_t           best()    const { return _best; }
+  const PlantRls&   rls(uint8_t i) const { return _bank[i]; }
+
+private:
+  void step(double y1);
+  bool toModel(const PlantRls& r, PlantModel& m) const;
+
+  PlantRls   _bank[PLANT_BANK];
+  float      _u[PLANT_HIST];       // średnie wypełnienie kolejnych kroków Ts
+  uint8_t    _uHead = 0;
+  uint8_t    _uLen  = 0;
+  double     _y = NAN;             // średnia temperatura poprzedniego kroku
+
+  uint32_t   _tStep = 0;
+  double     _sumT = 0, _sumU = 0;
+  uint32_t   _nSum = 0;
+
+  uint32_t   _updates = 0;
+  uint8_t    _best    = 0;
+  bool       _valid   = false;
+  PlantModel _model;
+};
+
+// czas [s] dojścia od fromC do toC przy stałym wypełnieniu dutyPct wg modelu
+// (bez opóźnienia); NAN gdy toC nieosiągalne
+double plantSecondsToReach(const PlantModel& m, double fromC, double toC, double dutyPct);
+
+// czas [s] przejścia od fromC do toC za rampą rateCph [°C/h] przy wypełnieniu najwyżej dutyPct:
+// piec nadąża, dopóki osiągalne nachylenie |T∞ − T|/tau ≥ rate, dalej dochodzi tym wypełnieniem
+// (rateCph = 0 – skok, od razu dutyPct). NAN bez modelu, INFINITY gdy toC nieosiągalne
+double plantSecondsOnRamp(const PlantModel& m, double fromC, double toC, double rateCph, double dutyPct);
@@ -0,0 +1,61 @@
+/***************************************************************************************
+ * FILE: src/profile_plan.cpp
+ * LAST MODIFIED: 2026-10-19 16:30 (Europe/Warsaw)
+ * PURPOSE: Skompilowany profil – kompilacja kroków do segmentów
+ ***************************************************************************************/
+#include "profile_plan.h"
+#include "control.h"
+#include <math.h>
+
+static uint32_t addSat(uint32_t a, uint32_t b) {
+  return (b >= PLAN_INFINITE - a) ? PLAN_INFINITE : a + b;
+}
+
+void planCompile(ProfilePlan& plan, const ProfileStep* steps, uint8_t n,
+                 uint8_t firstStep, int32_t startMilli) {
+  plan.len = 0;
+  uint32_t t    = 0;
+  int32_t  from = startMilli;
+
+  for (uint8_t i = firstStep; i < n; i++) {
+    const ProfileStep& st = steps[i];
+    const int32_t  to    = (int32_t)lround(st.targetC * 1000.0);
+    const int32_t  delta = to - from;
+    const uint16_t rate  = (delta >= 0) ? st.rampCph : st.rampDownCph;
+    const bool     ramp  = rate > 0 && delta != 0;
+    if (plan.len + (ramp ? 2 : 1) > PLAN_MAX_SEGS) break;   // pula pełna (walidacja tego pilnuje)
+
+    // rampa: |Δ| [m°C] / (rate·1000 [m°C/h]) → ms = |Δ|·3600 / rate
+    if (ramp) {
+      const uint64_t dur = (uint64_t)(delta < 0 ? -(int64_t)delta : delta) * 3600ULL / rate;
+      PlanSeg& r  = plan.seg[plan.len++];
+      r.startMs   = t;
+      r.durMs     = (dur > 2000000000ULL) ? 2000000000UL : (uint32_t)dur;   // ~23 dni – i tak bez sensu
+      r.fromMilli = from;
+      r.slopeMph  = (delta > 0 ? 1 : -1) * (int32_t)rate * 1000;
+      r.step      = i;
+      r.kind      = SEG_RAMP;
+      t = addSat(t, r.durMs);
+    }
+
+    PlanSeg& h  = plan.seg[plan.len++];
+    h.startMs   = t;
+    h.durMs     = !st.holdSec ? PLAN_INFINITE
+                : (st.holdSec > 2000000UL ? 2000000000UL : st.holdSec * 1000UL);
+    h.fromMilli = to;
+    h.slopeMph  = 0;
+    h.step      = i;
+    h.kind      = SEG_HOLD;
+    t = addSat(t, h.durMs);
+
+    from = to;
+  }
+  plan.totalMs = t;
+}
+
+uint32_t planStepEndMs(const ProfilePlan& plan, uint8_t idx) {
+  // po rampie zawsze jest hold tego samego kroku
+  if (idx < plan.len && plan.seg[idx].kind == SEG_RAMP && idx + 1 < plan.len) idx++;
+  if (idx >= plan.len) return plan.totalMs;
+  return addSat(plan.seg[idx].startMs, plan.seg[idx].durMs);
+}
@@ -0,0 +1,52 @@
+/***************************************************************************************
+ * FILE: src/profile_plan.h
+ * LAST MODIFIED: 2026-10-19 16:30 (Europe/Warsaw)
+ * PURPOSE: Skompilowany profil – odcinkowo-liniowa tabela czas → zadana
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+
+struct ProfileStep;   // control.h
+
+// Kroki (targetC / rampy / hold) kompilujemy raz – przy wczytaniu profilu, na starcie RUN
+// i przy ręcznym skoku kroku – do listy segmentów na wspólnej osi czasu planu.
+// Tick sterowania trzyma tylko indeks bieżącego segmentu: zadana, koniec etapu
+// i czas do końca programu to jedno odwołanie do tablicy + mnożenie, bez double.
+// Oś planu jest nominalna – czekanie na pasmo (bandC) ją zatrzymuje, nie przesuwa tabeli.
+
+enum PlanSegKind : uint8_t {
+  SEG_RAMP = 0,   // zadana liniowo: fromMilli + slope·t
+  SEG_HOLD = 1    // zadana stała = targetC kroku
+};
+
+static const uint32_t PLAN_INFINITE = 0xFFFFFFFFUL;   // hold bez końca (holdSec = 0)
+
+struct PlanSeg {
+  uint32_t startMs;     // początek segmentu na osi planu (suma poprzednich)
+  uint32_t durMs;       // długość segmentu, PLAN_INFINITE = bez końca
+  int32_t  fromMilli;   // zadana na początku segmentu [m°C]
+  int32_t  slopeMph;    // nachylenie [m°C/h], 0 dla holdu
+  uint8_t  step;        // indeks kroku w PROFILE
+  uint8_t  kind;        // PlanSegKind
+};
+
+// pula segmentów: rampa (pomijana gdy zerowa) + hold na każdy krok
+static const uint8_t PLAN_MAX_SEGS = 64;
+
+struct ProfilePlan {
+  PlanSeg  seg[PLAN_MAX_SEGS];
+  uint8_t  len     = 0;
+  uint32_t totalMs = 0;   // koniec ostatniego segmentu, PLAN_INFINITE gdy jest hold bez końca
+};
+
+// kroki od firstStep, pierwsza rampa od startMilli (bieżąca temperatura / zadana)
+void planCompile(ProfilePlan& plan, const ProfileStep* steps, uint8_t n,
+                 uint8_t firstStep, int32_t startMilli);
+
+// zadana [m°C] po inSegMs od początku segmentu (inSegMs < durMs)
+inline int32_t planSetpointMilli(const PlanSeg& s, uint32_t inSegMs) {
+  return s.fromMilli + (int32_t)((int64_t)s.slopeMph * inSegMs / 3600000LL);
+}
+
+// koniec kroku, do którego należy segment idx (na osi planu); PLAN_INFINITE dla holdu bez końca
+uint32_t planStepEndMs(const ProfilePlan& plan, uint8_t idx);
@@ -0,0 +1,93 @@
+/***************************************************************************************
+ * FILE: src/safety.cpp
+ * LAST MODIFIED: 2026-10-20 04:30 (Europe/Warsaw)
+ * PURPOSE: Nadzór bezpieczeństwa – implementacja
+ ***************************************************************************************/
+#include "safety.h"
+
+static const uint8_t  SF_CONFIRM       = 2;                 // ramki ponad próg (OVERTEMP / BOARD)
+static const uint32_t SF_WELD_SETTLE   = 10UL * 60000UL;    // po wyłączeniu piec jeszcze dochodzi
+static const uint32_t SF_WELD_WINDOW   = 20UL * 60000UL;
+static const int32_t  SF_NO_RISE_MILLI = 5000;              // minimalny przyrost w oknie NO_HEAT
+
+const char* safetyTripName(uint8_t t) {
+  switch (t) {
+    case TRIP_OVERTEMP: return "overtemp";
+    case TRIP_RELAY:    return "relay";
+    case TRIP_NO_HEAT:  return "no_heat";
+    case TRIP_BOARD:    return "board";
+    default:            return "none";
+  }
+}
+
+void SafetySupervisor::reset(uint32_t nowMs) {
+  _trip       = TRIP_NONE;
+  _tripMilli  = 0;
+  _tripMs     = 0;
+  _overN      = 0;
+  _boardN     = 0;
+  _offSinceMs = nowMs;
+  _weldArmed  = false;
+  _heatArmed  = false;
+}
+
+SafetyTrip IRAM_ATTR SafetySupervisor::latch(SafetyTrip t, uint32_t nowMs, int32_t milli) {
+  _trip      = t;
+  _tripMs    = nowMs;
+  _tripMilli = milli;
+  return t;
+}
+
+SafetyTrip IRAM_ATTR SafetySupervisor::sample(uint32_t nowMs, bool kilnOk, int32_t kilnMilli,
+                                    int32_t boardMilli, bool heatCmd, bool fullPower) {
+  if (_trip != TRIP_NONE) return _trip;
+
+  // sterownik – złącze zimne jest ważne także przy błędzie termopary
+  _boardN = (boardMilli > _lim.boardMaxMilli) ? (uint8_t)(_boardN + 1) : 0;
+  if (_boardN >= SF_CONFIRM) return latch(TRIP_BOARD, nowMs, boardMilli);
+
+  if (heatCmd) {
+    _offSinceMs = nowMs;
+    _weldArmed  = false;
+  }
+
+  // bez ważnej temperatury pieca okna zaczynają się od nowa (PID i tak nie grzeje)
+  if (!kilnOk) {
+    _overN     = 0;
+    _weldArmed = false;
+    _heatArmed = false;
+    return TRIP_NONE;
+  }
+
+  _overN = (kilnMilli > _lim.maxMilli) ? (uint8_t)(_overN + 1) : 0;
+  if (_overN >= SF_CONFIRM) return latch(TRIP_OVERTEMP, nowMs, kilnMilli);
+
+  // zgrzany SSR: okna po SF_WELD_WINDOW, minimum od początku okna – wolne zmiany
+  // otoczenia się nie sumują, wzrost przez granicę okna wykryty najpóźniej w drugim
+  if (_lim.weldRiseMilli > 0 && !heatCmd && nowMs - _offSinceMs >= SF_WELD_SETTLE) {
+    if (!_weldArmed || nowMs - _weldT0 >= SF_WELD_WINDOW) {
+      _weldArmed = true;
+      _weldT0    = nowMs;
+      _weldMin   = kilnMilli;
+    }
+    if (kilnMilli < _weldMin) _weldMin = kilnMilli;
+    if (kilnMilli - _weldMin >= _lim.weldRiseMilli) return latch(TRIP_RELAY, nowMs, kilnMilli - _weldMin);
+  }
+
+  // brak grzania: całe okno w limicie mocy, a piec prawie stoi
+  if (_lim.noRiseMs > 0 && fullPower) {
+    if (!_heatArmed) {
+      _heatArmed = true;
+      _heatT0    = nowMs;
+      _heatRef   = kilnMilli;
+    } else if (nowMs - _heatT0 >= _lim.noRiseMs) {
+      if (kilnMilli - _heatRef < SF_NO_RISE_MILLI) return latch(TRIP_NO_HEAT, nowMs, kilnMilli - _heatRef);
+      _heatT0  = nowMs;
+      _heatRef = kilnMilli;
+    }
+  } else {
+    _heatArmed = false;
+  }
+
+  return TRIP_NONE;
+}
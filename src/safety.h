@@ -0,0 +1,75 @@
+/***************************************************************************************
+ * FILE: src/safety.h
+ * LAST MODIFIED: 2026-10-20 04:30 (Europe/Warsaw)
+ * PURPOSE: Nadzór bezpieczeństwa – przegrzanie, zgrzany SSR, brak grzania, gorący sterownik
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+
+// Oceniany na każdej ramce MAX31855 (co 250 ms) prosto z przerwania akwizycji (timer1) –
+// obok ścieżki PID / profilu, na liczbach całkowitych (m°C), bez pamięci dynamicznej;
+// sample() w IRAM, bo przerwanie może trafić w zapis flash:
+//  • OVERTEMP – piec powyżej CFG.maxTempC przez 2 kolejne ramki (pojedyncza zła ramka
+//    nie zatrzyma wypału);
+//  • BOARD – złącze zimne MAX31855 (≈ temperatura sterownika) powyżej CFG.safety.boardMaxC,
+//    też 2 ramki;
+//  • RELAY – wszystkie sekcje zadane jako wyłączone od co najmniej 10 min (bezwładność
+//    grzałek minęła), a piec rośnie o ≥ CFG.safety.weldRiseC w oknie 20 min → zgrzany SSR;
+//  • NO_HEAT – wypełnienie w limicie mocy przez CFG.safety.noRiseMin, a przyrost < 5 °C
+//    → przerwana grzałka albo termopara wypadła z komory (domyślnie wyłączone).
+// Zadziałanie jest zatrzaskiwane do reset() (potwierdzenie z WWW: POST /safety/ack).
+// Opóźnienie reakcji OVERTEMP / BOARD: ≤ 2 okresy akwizycji (500 ms) od przekroczenia progu
+// do zgaszenia pinów z tego samego przerwania – niezależnie od blokad loop() (test_safety).
+
+enum SafetyTrip : uint8_t {
+  TRIP_NONE     = 0,
+  TRIP_OVERTEMP = 1,
+  TRIP_RELAY    = 2,
+  TRIP_NO_HEAT  = 3,
+  TRIP_BOARD    = 4
+};
+
+const char* safetyTripName(uint8_t t);
+
+struct SafetyLimits {
+  int32_t  maxMilli      = 950000;   // piec [m°C]
+  int32_t  boardMaxMilli = 70000;    // sterownik [m°C]
+  int32_t  weldRiseMilli = 10000;    // przyrost przy wyłączonych SSR [m°C], 0 = bez kontroli
+  uint32_t noRiseMs      = 0;        // okno kontroli grzania przy pełnej mocy, 0 = bez kontroli
+};
+
+class SafetySupervisor {
+public:
+  void configure(const SafetyLimits& lim) { _lim = lim; }
+  void reset(uint32_t nowMs);
+
+  // jedna ramka: kilnOk – termopara bez błędu (kilnMilli ważne); boardMilli – złącze zimne;
+  // heatCmd – któraś sekcja zadana jako włączona; fullPower – RUN z wypełnieniem w limicie mocy.
+  // Zwraca zatrzaśnięty powód (TRIP_NONE = w porządku)
+  SafetyTrip sample(uint32_t nowMs, bool kilnOk, int32_t kilnMilli, int32_t boardMilli,
+                    bool heatCmd, bool fullPower);
+
+  SafetyTrip trip()      const { return _trip; }
+  int32_t    tripMilli() const { return _tripMilli; }   // wartość, która przekroczyła próg
+  uint32_t   tripMs()    const { return _tripMs; }      // chwila ramki, na której zadziałał
+
+private:
+  SafetyTrip latch(SafetyTrip t, uint32_t nowMs, int32_t milli);
+
+  SafetyLimits _lim;
+  SafetyTrip   _trip      = TRIP_NONE;
+  int32_t      _tripMilli = 0;
+  uint32_t     _tripMs    = 0;
+
+  uint8_t  _overN  = 0;         // kolejne ramki powyżej maxMilli
+  uint8_t  _boardN = 0;         // kolejne ramki powyżej boardMaxMilli
+
+  uint32_t _offSinceMs = 0;     // od kiedy wszystkie sekcje zadane jako wyłączone
+  bool     _weldArmed  = false;
+  uint32_t _weldT0     = 0;     // początek okna RELAY
+  int32_t  _weldMin    = 0;     // minimum w oknie
+
+  bool     _heatArmed  = false;
+  uint32_t _heatT0     = 0;     // początek okna NO_HEAT
+  int32_t  _heatRef    = 0;     // temperatura na początku okna
+};
@@ -0,0 +1,61 @@
+/***************************************************************************************
+ * FILE: src/smith_predictor.cpp
+ * LAST MODIFIED: 2026-10-19 20:40 (Europe/Warsaw)
+ * PURPOSE: Predyktor Smitha – implementacja
+ ***************************************************************************************/
+#include "smith_predictor.h"
+#include <math.h>
+
+void SmithPredictor::configure(const PlantModel& m) {
+  const uint32_t thetaMs = (uint32_t)(m.deadSec * 1000.0f);
+  const bool ok = m.K > 0.0f && m.tauSec > 0.0f && thetaMs >= 1000UL;
+  if (!ok) { _active = false; return; }
+
+  // krok 1 s, a dla bardzo długiego opóźnienia tyle, żeby theta zmieściła się w historii
+  uint32_t ts = 1000UL;
+  if (thetaMs / ts >= HIST) ts = thetaMs / (HIST - 1) + 1;
+  const bool restart = !_active || ts != _tsMs;
+
+  _tsMs = ts;
+  _n    = (uint16_t)((thetaMs + ts / 2) / ts);
+  const double a = exp(-(double)ts / (m.tauSec * 1000.0));
+  _a  = q16FromDouble(a);
+  _bK = q16FromDouble((1.0 - a) * m.K);
+
+  // nowa estymata tego samego modelu – stan i historia zostają (bez skoku korekty)
+  if (restart) {
+    _active = true;
+    reset(0);
+  }
+}
+
+void SmithPredictor::reset(q16_t dutyQ) {
+  // stan ustalony: x = K·u = bK/(1−a)·u
+  const int64_t oneMinusA = Q16_ONE - _a;
+  _x = oneMinusA > 0 ? (q16_t)(((int64_t)_bK * dutyQ) / oneMinusA) : 0;
+  for (uint16_t i = 0; i < HIST; i++) _hist[i] = _x;
+  _head  = 0;
+  _tStep = millis();
+  _uSum  = 0;
+  _uN    = 0;
+  _corrRate = 0;
+}
+
+void SmithPredictor::update(uint32_t nowMs, q16_t dutyQ) {
+  if (!_active) return;
+  _uSum += dutyQ;
+  _uN++;
+  if (nowMs - _tStep < _tsMs) return;
+  _tStep += _tsMs;
+  if (nowMs - _tStep >= _tsMs) _tStep = nowMs;   // pętla stała – bez nadrabiania kroków
+
+  const q16_t u = (q16_t)(_uSum / _uN);
+  _uSum = 0;
+  _uN   = 0;
+
+  const q16_t c0 = correction();
+  _hist[_head] = _x;
+  _head = (_head + 1) % HIST;
+  _x = (q16_t)((((int64_t)_a * _x) + ((int64_t)_bK * u)) >> 16);
+  _corrRate = (q16_t)((int64_t)(correction() - c0) * 1000 / (int64_t)_tsMs);
+}
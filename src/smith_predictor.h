@@ -0,0 +1,51 @@
+/***************************************************************************************
+ * FILE: src/smith_predictor.h
+ * LAST MODIFIED: 2026-10-19 20:40 (Europe/Warsaw)
+ * PURPOSE: Predyktor Smitha – kompensacja opóźnienia termopary (model FOPDT)
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+#include "pid_fixed.h"
+#include "config.h"
+
+// Model FOPDT bez opóźnienia liczony równolegle z obiektem: x[k+1] = a·x[k] + (1−a)·K·u[k]
+// (odchyłka od otoczenia – Tamb się skraca). PID dostaje pomiar + (x − x opóźnione o theta),
+// czyli to, co termopara pokaże za theta sekund. Gdy model jest dokładny, opóźnienie
+// wypada z pętli; błąd modelu wraca przez pomiar, więc statyka zostaje poprawna.
+// W ticku tylko int64 – exp() i dzielenia w configure(), przy zmianie modelu.
+
+class SmithPredictor {
+public:
+  // K / tauSec / deadSec z modelu; K = 0 lub theta krótsza niż krok → wyłączony
+  void configure(const PlantModel& m);
+  bool active() const { return _active; }
+
+  // model w stanie ustalonym dla wypełnienia dutyQ (korekta = 0) – start / zmiana kroku
+  void reset(q16_t dutyQ);
+
+  // co tick: wypełnienie podane na grzałki (Q16.16 %); krok modelu co _tsMs
+  void update(uint32_t nowMs, q16_t dutyQ);
+
+  // przewidywany przyrost pomiaru w ciągu theta [°C Q16.16] – dodawany do wejścia PID
+  q16_t correction() const { return _active ? _x - _hist[_delayIdx()] : 0; }
+  // szybkość zmian korekty [°C/s Q16.16] – do D, gdy ten liczy z estymaty nachylenia
+  q16_t correctionRate() const { return _active ? _corrRate : 0; }
+
+private:
+  static const uint16_t HIST = 256;   // theta ≤ HIST kroków; dłuższe → dłuższy krok
+
+  uint16_t _delayIdx() const { return (uint16_t)((_head + HIST - _n) % HIST); }
+
+  bool     _active = false;
+  uint32_t _tsMs   = 1000;
+  uint16_t _n      = 0;         // opóźnienie w krokach
+  q16_t    _a      = 0;         // exp(−Ts/tau)
+  q16_t    _bK     = 0;         // (1−a)·K [°C/%]
+  q16_t    _x      = 0;         // stan modelu bez opóźnienia [°C]
+  q16_t    _hist[HIST];         // poprzednie _x, _head = najstarszy wpis do nadpisania
+  uint16_t _head   = 0;
+  uint32_t _tStep  = 0;
+  int64_t  _uSum   = 0;         // średnie wypełnienie w kroku (okno SSR krótsze niż krok)
+  uint32_t _uN     = 0;
+  q16_t    _corrRate = 0;
+};
@@ -0,0 +1,48 @@
+/***************************************************************************************
+ * FILE: src/spsc_queue.h
+ * LAST MODIFIED: 2026-10-20 04:30 (Europe/Warsaw)
+ * PURPOSE: Kolejka bez blokad: jeden producent (timer) → jeden konsument (pętla sterowania)
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+
+// Bufor kołowy o stałej pojemności (potęga 2, jedna komórka zawsze wolna).
+// Producent pisze tylko _head, konsument tylko _tail – ESP8266 ma jeden rdzeń,
+// więc wystarczy bariera kompilatora między zapisem danych a przesunięciem indeksu.
+template <typename T, uint8_t N>
+class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue: N musi byc potega 2");
+
+public:
+  // producent (także z przerwania – kod w IRAM); false gdy kolejka pełna (licznik dropped++)
+  IRAM_ATTR bool push(const T& v) {
+    const uint8_t h    = _head;
+    const uint8_t next = (uint8_t)((h + 1) & (N - 1));
+    if (next == _tail) { _dropped++; return false; }
+    _buf[h] = v;
+    barrier();
+    _head = next;
+    return true;
+  }
+
+  // konsument; false gdy pusto
+  bool pop(T& out) {
+    const uint8_t t = _tail;
+    if (t == _head) return false;
+    out = _buf[t];
+    barrier();
+    _tail = (uint8_t)((t + 1) & (N - 1));
+    return true;
+  }
+
+  bool     empty()   const { return _tail == _head; }
+  uint32_t dropped() const { return _dropped; }
+
+private:
+  static inline void barrier() { __asm__ __volatile__("" ::: "memory"); }
+
+  T                 _buf[N];
+  volatile uint8_t  _head    = 0;
+  volatile uint8_t  _tail    = 0;
+  volatile uint32_t _dropped = 0;
+};
@@ -0,0 +1,126 @@
+/***************************************************************************************
+ * FILE: src/ssr_modulator.cpp
+ * LAST MODIFIED: 2026-10-20 03:50 (Europe/Warsaw)
+ * PURPOSE: Modulacja SSR – implementacja strategii
+ ***************************************************************************************/
+#include "ssr_modulator.h"
+
+static const q16_t    FULL       = 100 * Q16_ONE;
+static const uint32_t BURST_NONE = 0xFFFFFFFFUL;   // okno BURST jeszcze nie policzone
+
+const char* ssrModName(uint8_t mod) {
+  switch (mod) {
+    case SSR_MOD_SIGMA_DELTA: return "sigma-delta";
+    case SSR_MOD_BURST:       return "burst";
+    default:                  return "window";
+  }
+}
+
+void SsrModulator::configure(uint8_t mod, uint32_t periodMs, uint8_t mainsHz, uint8_t banks) {
+  if (mainsHz != 60) mainsHz = 50;
+  _banks = (banks < 1) ? 1 : (banks > SSR_MOD_BANKS_MAX ? SSR_MOD_BANKS_MAX : banks);
+  _mod = (mod <= SSR_MOD_BURST) ? mod : (uint8_t)SSR_MOD_WINDOW;
+  // sigma-delta co półokres, burst w całych okresach (bez składowej stałej w sieci)
+  _qMs = (_mod == SSR_MOD_SIGMA_DELTA) ? 500UL / mainsHz : 1000UL / mainsHz;
+  if (periodMs < 10 * _qMs) periodMs = 10 * _qMs;   // okno co najmniej 10 kwantów
+  if (periodMs > 60000UL)   periodMs = 60000UL;
+  _periodMs = periodMs;
+  reset(millis());
+}
+
+void SsrModulator::reset(uint32_t nowMs) {
+  _tStart = nowMs;
+  _mask   = 0;
+  _k      = 0;
+  _rr     = 0;
+  _acc    = 0;
+  _burstQ = BURST_NONE;
+}
+
+static inline q16_t clampDuty(q16_t d) {
+  return d < 0 ? 0 : (d > FULL ? FULL : d);
+}
+
+// sekcje, których okno obejmuje chwilę e okna bazowego; okno sekcji i przesunięte
+// o ⌊units·i/N⌋·unitMs (units·unitMs = okno), włączone przez onMs od swojego początku –
+// łuk może przejść przez koniec okna bazowego
+static uint8_t arcMask(uint32_t e, uint32_t onMs, uint32_t units, uint32_t unitMs,
+                       uint8_t banks, uint32_t periodMs) {
+  uint8_t m = 0;
+  for (uint8_t i = 0; i < banks; i++) {
+    const uint32_t s = units * i / banks * unitMs;
+    const uint32_t t = (e >= s) ? e - s : e + periodMs - s;
+    if (t < onMs) m |= (uint8_t)(1u << i);
+  }
+  return m;
+}
+
+uint8_t SsrModulator::step(uint32_t nowMs, q16_t dutyQ) {
+  const q16_t duty = clampDuty(dutyQ);
+  // najwięcej sekcji naraz: ⌈N·duty⌉
+  const int64_t level = (int64_t)duty * _banks;
+  const uint8_t kMax  = (uint8_t)((level + FULL - 1) / FULL);
+
+  switch (_mod) {
+    case SSR_MOD_SIGMA_DELTA: {
+      // decyzja najwyżej raz na kwant; błąd liczony z faktycznie podanego czasu,
+      // więc nierówne odstępy między wywołaniami nie psują średniej
+      const uint32_t dt = nowMs - _tStart;
+      if (dt < _qMs) return _mask;
+      int64_t acc = _acc + (level - (int64_t)_k * FULL) * dt / _qMs;
+      // normalnie |acc| ≤ FULL/2; po postoju pętli – bez długiego nadrabiania
+      if (acc >  2 * FULL) acc =  2 * FULL;
+      if (acc < -2 * FULL) acc = -2 * FULL;
+      _acc = (int32_t)acc;
+      // k sekcji w następnym kwancie: błąd po nim wraca do [−FULL/2, FULL/2)
+      int64_t k = (acc + level + FULL / 2) / FULL;
+      if (k < 0)    k = 0;
+      if (k > kMax) k = kMax;
+      _k = (uint8_t)k;
+      // k kolejnych sekcji od _rr (z zawinięciem) – każda dostaje równy udział
+      const uint8_t all = (uint8_t)((1u << _banks) - 1u);
+      const uint16_t m  = (uint16_t)(((1u << _k) - 1u) << _rr);
+      _mask   = (uint8_t)((m | (m >> _banks)) & all);
+      _rr     = (uint8_t)((_rr + _k) % _banks);
+      _tStart = nowMs;
+      return _mask;
+    }
+
+    case SSR_MOD_BURST: {
+      if (nowMs - _tStart >= _periodMs) {
+        _tStart = (nowMs - _tStart >= 2 * _periodMs) ? nowMs : _tStart + _periodMs;
+        _burstQ = BURST_NONE;
+      }
+      // sekcje przesunięte o całe okresy sieci (bez składowej stałej)
+      const uint32_t perQ = _periodMs / _qMs;
+      const uint32_t gapQ = perQ / _banks;
+      if (_burstQ == BURST_NONE) {
+        // pierwsze wywołanie w oknie: ile całych okresów, reszta do następnego okna;
+        // paczka nie dłuższa niż kMax odstępów – przeniesienie nie dołoży sekcji ponad ⌈N·d⌉;
+        // przy kMax = N całe okno (N·gapQ gubi resztę z dzielenia: 3 sekcje → 99 %)
+        const int64_t want = (int64_t)duty * perQ + _acc;
+        const int64_t qMax = (kMax >= _banks) ? (int64_t)perQ : (int64_t)kMax * gapQ;
+        int64_t q = want / FULL;
+        if (q > qMax) q = qMax;
+        if (q < 0) q = 0;
+        int64_t rest = want - q * FULL;
+        if (rest >  FULL) rest =  FULL;   // obcięta paczka – bez rosnącego długu
+        _acc    = (int32_t)rest;
+        _burstQ = (uint32_t)q;
+      }
+      _mask = arcMask(nowMs - _tStart, _burstQ * _qMs, perQ, _qMs, _banks, _periodMs);
+      return _mask;
+    }
+
+    default: {
+      // siatka okien trzymana (+period) – przesunięcia sekcji liczone od wspólnego początku
+      if (nowMs - _tStart >= _periodMs) {
+        _tStart = (nowMs - _tStart >= 2 * _periodMs) ? nowMs : _tStart + _periodMs;
+      }
+      // 100 % = 100<<16; po >>8 zostaje 0..25600, × okno (≤ 60 s) mieści się w uint32
+      const uint32_t onMs = ((uint32_t)duty >> 8) * _periodMs / 25600UL;
+      _mask = arcMask(nowMs - _tStart, onMs, _periodMs, 1, _banks, _periodMs);
+      return _mask;
+    }
+  }
+}
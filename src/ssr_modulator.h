@@ -0,0 +1,63 @@
+/***************************************************************************************
+ * FILE: src/ssr_modulator.h
+ * LAST MODIFIED: 2026-10-19 21:40 (Europe/Warsaw)
+ * PURPOSE: Modulacja SSR – wypełnienie (Q16.16 %) → stan wyjścia w danej chwili
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+#include "pid_fixed.h"
+
+// Strategie (CFG.pid.ssrMod) – kompromis: liczba przełączeń SSR ↔ tętnienia temperatury:
+//  • WINDOW – klasyczne okno czasowe CFG.pid.windowMs: włączone na początku okna
+//    przez duty·okno; 2 przełączenia na okno, tętnienia rosną z długością okna;
+//  • SIGMA_DELTA – decyzja co półokres sieci (SSR z detekcją zera i tak przełącza
+//    tylko w zerze), błąd przenoszony dalej: włączenia rozłożone możliwie równo,
+//    najmniejsze tętnienia, najwięcej przełączeń (rozdzielczość = częstość loop());
+//  • BURST – pełne okresy sieci w paczkach: w każdym oknie windowMs jedna paczka
+//    całych okresów, reszta zaokrąglenia przechodzi do następnego okna (średnia dokładna).
+// Czas liczony z millis(): po postoju pętli bez nadrabiania zaległych włączeń.
+//
+// Kilka sekcji grzałek (banks > 1): każda dostaje to samo wypełnienie (100 % = wszystkie
+// sekcje), ale nie razem – WINDOW/BURST przesuwają okno sekcji i o period·i/N,
+// SIGMA_DELTA liczy jeden akumulator dla całego pieca i co kwant włącza k sekcji po
+// kolei (round-robin). Naraz grzeje najwyżej ⌈N·duty⌉ sekcji – ogranicznik mocy
+// chwilowej sprowadza się do obcięcia wypełnienia do maxOn/N.
+
+static const uint8_t SSR_MOD_BANKS_MAX = 3;   // SSR, SSR2, SSR3
+
+enum SsrMod : uint8_t {
+  SSR_MOD_WINDOW      = 0,
+  SSR_MOD_SIGMA_DELTA = 1,
+  SSR_MOD_BURST       = 2
+};
+
+const char* ssrModName(uint8_t mod);
+
+class SsrModulator {
+public:
+  // periodMs – okno WINDOW/BURST; mainsHz – 50/60 (kwant SIGMA_DELTA / BURST);
+  // banks – liczba sekcji grzałek (1..SSR_MOD_BANKS_MAX)
+  void configure(uint8_t mod, uint32_t periodMs, uint8_t mainsHz, uint8_t banks = 1);
+  void reset(uint32_t nowMs);
+
+  // stan sekcji dla chwili nowMs przy wypełnieniu dutyQ (0..100 % Q16.16): bit i = SSR sekcji i
+  uint8_t step(uint32_t nowMs, q16_t dutyQ);
+
+  uint8_t  mod()      const { return _mod; }
+  uint8_t  banks()    const { return _banks; }
+  uint32_t periodMs() const { return _periodMs; }
+
+private:
+  uint8_t  _mod      = SSR_MOD_WINDOW;
+  uint32_t _periodMs = 2000;
+  uint32_t _qMs      = 10;      // kwant: półokres (SIGMA_DELTA) / okres sieci (BURST)
+
+  uint8_t  _banks    = 1;
+
+  uint32_t _tStart   = 0;       // początek okna (WINDOW/BURST) albo bieżącego kwantu
+  uint8_t  _mask     = 0;       // bieżący stan sekcji
+  uint8_t  _k        = 0;       // SIGMA_DELTA: sekcje włączone w bieżącym kwancie
+  uint8_t  _rr       = 0;       // SIGMA_DELTA: pierwsza sekcja następnego kwantu (round-robin)
+  int32_t  _acc      = 0;       // akumulator błędu (Q16.16 %)
+  uint32_t _burstQ   = 0;       // okresy sieci włączone w bieżącym oknie BURST
+};
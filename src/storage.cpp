@@ -1,19 +1,176 @@
 /***************************************************************************************
  * FILE: src/storage.cpp
- * LAST MODIFIED: 2025-11-09 07:05 (Europe/Warsaw)
- * PURPOSE: Minimal stubs for profile persistence (replace with real LittleFS later)
+ * LAST MODIFIED: 2026-10-20 00:40 (Europe/Warsaw)
+ * PURPOSE: Binary profile snapshot (steps + compiled plan) on LittleFS + run checkpoint
  ***************************************************************************************/
 #include "storage.h"
 #include "control.h"
+#include "profile_plan.h"
 
-// NOTE: Stubs – replace with real LittleFS JSON load/save.
-bool loadProfile(ProfileStep* outArray, uint8_t maxLen, uint8_t& outLen) {
-  (void)outArray; (void)maxLen;
-  outLen = 0;                // no steps loaded
+#include <FS.h>
+#include <LittleFS.h>
+
+static const char*    FILE_PROFILE_BIN = "/profile.bin";
+static const uint32_t PROFILE_BIN_MAGIC = 0x4B504C31UL;   // "KPL1"
+
+struct ProfileBinHeader {
+  uint32_t magic;
+  uint16_t stepSize;   // sizeof(ProfileStep) – layout change invalidates the file
+  uint16_t segSize;    // sizeof(PlanSeg)
+  uint8_t  len;        // steps
+  uint8_t  planLen;    // segments
+  uint16_t reserved;
+  uint32_t totalMs;
+  uint32_t crc;        // CRC32 of steps + segments
+};
+
+static uint32_t crc32Update(uint32_t crc, const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (len--) {
+    crc ^= *p++;
+    for (uint8_t k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+  }
+  return crc;
+}
+
+bool loadProfile(ProfileStep* outArray, uint8_t maxLen, uint8_t& outLen, ProfilePlan& plan) {
+  outLen = 0;
+  if (!LittleFS.exists(FILE_PROFILE_BIN)) return false;
+  File f = LittleFS.open(FILE_PROFILE_BIN, "r"); if (!f) return false;
+
+  ProfileBinHeader h;
+  bool ok = f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+            h.magic == PROFILE_BIN_MAGIC &&
+            h.stepSize == sizeof(ProfileStep) && h.segSize == sizeof(PlanSeg) &&
+            h.len <= maxLen && h.planLen <= PLAN_MAX_SEGS;
+
+  if (ok) {
+    const size_t stepBytes = (size_t)h.len * sizeof(ProfileStep);
+    const size_t segBytes  = (size_t)h.planLen * sizeof(PlanSeg);
+    ok = f.read((uint8_t*)outArray, stepBytes) == stepBytes &&
+         f.read((uint8_t*)plan.seg, segBytes) == segBytes;
+    if (ok) {
+      uint32_t crc = crc32Update(0xFFFFFFFFUL, outArray, stepBytes);
+      crc = crc32Update(crc, plan.seg, segBytes);
+      ok = (crc == h.crc);
+    }
+  }
+  f.close();
+  if (!ok) { plan.len = 0; return false; }
+
+  outLen       = h.len;
+  plan.len     = h.planLen;
+  plan.totalMs = h.totalMs;
   return true;
 }
 
-bool saveProfile(const ProfileStep* inArray, uint8_t len) {
-  (void)inArray; (void)len;
+bool saveProfile(const ProfileStep* inArray, uint8_t len, const ProfilePlan& plan) {
+  ProfileBinHeader h;
+  h.magic    = PROFILE_BIN_MAGIC;
+  h.stepSize = sizeof(ProfileStep);
+  h.segSize  = sizeof(PlanSeg);
+  h.len      = len;
+  h.planLen  = plan.len;
+  h.reserved = 0;
+  h.totalMs  = plan.totalMs;
+
+  const size_t stepBytes = (size_t)len * sizeof(ProfileStep);
+  const size_t segBytes  = (size_t)plan.len * sizeof(PlanSeg);
+  h.crc = crc32Update(crc32Update(0xFFFFFFFFUL, inArray, stepBytes), plan.seg, segBytes);
+
+  File f = LittleFS.open(FILE_PROFILE_BIN, "w"); if (!f) return false;
+  bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+            f.write((const uint8_t*)inArray, stepBytes) == stepBytes &&
+            f.write((const uint8_t*)plan.seg, segBytes) == segBytes;
+  f.close();
+  if (!ok) LittleFS.remove(FILE_PROFILE_BIN);
+  return ok;
+}
+
+uint32_t profileCrc(const ProfileStep* steps, uint8_t len) {
+  return crc32Update(0xFFFFFFFFUL, steps, (size_t)len * sizeof(ProfileStep));
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Run checkpoint (RTC user memory + /run.ckp)
+// ────────────────────────────────────────────────────────────────────────────────
+
+static const char*    FILE_RUN_CKP  = "/run.ckp";
+static const uint32_t CKPT_MAGIC    = 0x4B434B32UL;   // "KCK2"
+static const uint32_t CKPT_RTC_OFS  = 64;             // in 4-byte blocks; the low half is left to eboot/OTA
+static const uint32_t CKPT_FLASH_MS = 300000UL;       // flash copy at most every 5 min (wear)
+
+static_assert(sizeof(RunCheckpoint) % 4 == 0, "RTC memory is written in 4-byte blocks");
+static_assert(CKPT_RTC_OFS * 4 + sizeof(RunCheckpoint) <= 512, "RTC user memory is 512 B");
+
+static RunCheckpoint g_ckpt;              // last put – source of the deferred flash write
+static uint32_t      g_ckptSeq     = 0;
+static bool          g_ckptDirty   = false;
+static bool          g_ckptUrgent  = false;
+static bool          g_ckptRemove  = false;
+static uint32_t      g_ckptFlashMs = 0;
+
+static uint32_t ckptCrc(const RunCheckpoint& cp) {
+  return crc32Update(0xFFFFFFFFUL, &cp, offsetof(RunCheckpoint, crc));
+}
+
+static bool ckptValid(const RunCheckpoint& cp) {
+  return cp.magic == CKPT_MAGIC && cp.crc == ckptCrc(cp);
+}
+
+void checkpointPut(const RunCheckpoint& cp, bool urgent) {
+  g_ckpt       = cp;
+  g_ckpt.magic = CKPT_MAGIC;
+  g_ckpt.seq   = ++g_ckptSeq;
+  g_ckpt.crc   = ckptCrc(g_ckpt);
+  ESP.rtcUserMemoryWrite(CKPT_RTC_OFS, (uint32_t*)&g_ckpt, sizeof(g_ckpt));
+  g_ckptDirty   = true;
+  g_ckptUrgent |= urgent;
+  g_ckptRemove  = false;
+}
+
+void checkpointClear() {
+  RunCheckpoint cp;
+  memset(&cp, 0, sizeof(cp));
+  checkpointPut(cp, false);   // inactive record in RTC – a reset will not resume
+  g_ckptDirty  = false;
+  g_ckptRemove = true;        // the flash copy goes away in checkpointLoop()
+}
+
+bool checkpointLoad(RunCheckpoint& cp) {
+  RunCheckpoint rtc, fl;
+  const bool rtcOk = ESP.rtcUserMemoryRead(CKPT_RTC_OFS, (uint32_t*)&rtc, sizeof(rtc)) && ckptValid(rtc);
+
+  bool flOk = false;
+  File f = LittleFS.open(FILE_RUN_CKP, "r");
+  if (f) {
+    flOk = f.read((uint8_t*)&fl, sizeof(fl)) == sizeof(fl) && ckptValid(fl);
+    f.close();
+  }
+
+  if (!rtcOk && !flOk) return false;
+  // after a reset both exist and RTC is newer (or equal); after a power cut RTC is garbage
+  cp = (rtcOk && (!flOk || rtc.seq >= fl.seq)) ? rtc : fl;
+  g_ckptSeq = cp.seq;   // continue numbering – new copies stay newer than the old file
   return true;
 }
+
+void checkpointLoop() {
+  if (g_ckptRemove) {
+    g_ckptRemove = false;
+    if (LittleFS.exists(FILE_RUN_CKP)) LittleFS.remove(FILE_RUN_CKP);
+    return;
+  }
+  if (!g_ckptDirty) return;
+  const uint32_t now = millis();
+  if (!g_ckptUrgent && g_ckptFlashMs && now - g_ckptFlashMs < CKPT_FLASH_MS) return;
+
+  g_ckptDirty   = false;
+  g_ckptUrgent  = false;
+  g_ckptFlashMs = now ? now : 1;
+  File f = LittleFS.open(FILE_RUN_CKP, "w");
+  if (!f) return;
+  const bool ok = f.write((const uint8_t*)&g_ckpt, sizeof(g_ckpt)) == sizeof(g_ckpt);
+  f.close();
+  if (!ok) LittleFS.remove(FILE_RUN_CKP);
+}
@@ -1,18 +1,57 @@
 /***************************************************************************************
  * FILE: src/storage.h
- * LAST MODIFIED: 2025-11-09 07:05 (Europe/Warsaw)
- * PURPOSE: Profile/load/save API (no duplicate struct definitions)
+ * LAST MODIFIED: 2026-10-20 00:40 (Europe/Warsaw)
+ * PURPOSE: Profile/load/save API (no duplicate struct definitions) + run checkpoint
  ***************************************************************************************/
 #pragma once
 #include <Arduino.h>
 
-// Forward declaration – the full definition lives in control.h
+// Forward declaration – the full definitions live in control.h / profile_plan.h
 struct ProfileStep;
+struct ProfilePlan;
 
-// Load up to maxLen steps into outArray; write actual count to outLen.
-// Return true on success.
-bool loadProfile(ProfileStep* outArray, uint8_t maxLen, uint8_t& outLen);
+// Binary snapshot of the active profile together with its compiled plan
+// (/profile.bin, magic + layout sizes + CRC32). /profile.json stays the source of
+// truth; the snapshot only saves the JSON parse + compile at boot.
+
+// Load up to maxLen steps into outArray and the compiled plan into plan;
+// write actual count to outLen. Return false when missing, stale or corrupt.
+bool loadProfile(ProfileStep* outArray, uint8_t maxLen, uint8_t& outLen, ProfilePlan& plan);
 
-// Save len steps from inArray.
+// Save len steps from inArray together with their compiled plan.
 // Return true on success.
-bool saveProfile(const ProfileStep* inArray, uint8_t len);
+bool saveProfile(const ProfileStep* inArray, uint8_t len, const ProfilePlan& plan);
+
+// CRC32 of the steps only – identifies the program a run checkpoint belongs to.
+uint32_t profileCrc(const ProfileStep* steps, uint8_t len);
+
+// Run checkpoint for power-loss resume. Two copies:
+//  • RTC user memory – written on every checkpointPut() (a few µs), survives resets
+//    and watchdog reboots but not a real power cut;
+//  • /run.ckp on LittleFS – written from checkpointLoop() in loop(), never from the
+//    control tick: at most every CKPT_FLASH_MS, sooner when marked urgent (step change).
+// Both carry magic + CRC32; checkpointLoad() returns the newer valid one (seq).
+struct RunCheckpoint {
+  uint32_t magic;
+  uint32_t seq;          // write counter – newer copy wins
+  uint32_t runRev;       // RUN_REV of the interrupted run
+  uint32_t profileCrc;   // profileCrc() of the program (0 outside profile mode)
+  uint32_t inSegMs;      // time spent in the current plan segment
+  uint32_t runSec;       // run time so far
+  uint32_t runWh;        // run energy so far
+  int32_t  setMilli;     // setpoint [m°C]
+  int32_t  tempMilli;    // kiln temperature when written [m°C]
+  int32_t  heatTeqMilli; // heat work so far as its 60 °C/h equivalent temperature [m°C]
+  uint8_t  active;       // 0 = no run to resume
+  uint8_t  mode;         // Mode
+  uint8_t  step;         // PROFILE_ACTIVE
+  uint8_t  segKind;      // PlanSegKind of the current segment
+  uint8_t  phase;        // PROFILE_PHASE
+  uint8_t  reserved[3];
+  uint32_t crc;          // CRC32 of everything above
+};
+
+void checkpointPut(const RunCheckpoint& cp, bool urgent);
+void checkpointClear();                     // run ended – nothing to resume
+bool checkpointLoad(RunCheckpoint& cp);     // newest valid copy; false when none
+void checkpointLoop();                      // deferred flash write, call from loop()
@@ -0,0 +1,87 @@
+/***************************************************************************************
+ * FILE: src/temp_estimator.cpp
+ * LAST MODIFIED: 2026-10-19 20:40 (Europe/Warsaw)
+ * PURPOSE: Estymator temperatury i nachylenia – implementacja
+ ***************************************************************************************/
+#include "temp_estimator.h"
+#include <math.h>
+
+// wariancje: pomiar (0.25²/12 kwantyzacji + ~0.15 °C szumu), błąd modelu na krok,
+// błądzenie nachylenia – ~10 °C/h na minutę, żeby zmiana rampy była złapana w 2–3 min
+static const double KF_R  = 0.25 * 0.25 / 12.0 + 0.15 * 0.15;
+static const double KF_QT = 0.002 * 0.002;
+static const double KF_QB_PER_S = (10.0 / 3600.0 / 60.0) * (10.0 / 3600.0 / 60.0);
+
+// wejście modelu przez filtr 1. rzędu: okno SSR i bezwładność osłony termopary –
+// bez tego nachylenie z modelu skacze z każdym oknem i D zaczyna sterować szumem
+static const double KF_U_TAU_S = 20.0;
+
+static const double Q32 = 4294967296.0;
+
+void TempEstimator::begin(uint32_t tsMs) {
+  _tsMs = tsMs ? tsMs : 250;
+  const double ts = _tsMs / 1000.0;
+  const double qb = KF_QB_PER_S * ts;
+
+  // F = [[1, ts], [0, 1]], H = [1, 0] – iteracja Riccatiego do stanu ustalonego
+  double p00 = 1.0, p01 = 0.0, p11 = 1e-4, l1 = 0.0, l2 = 0.0;
+  for (uint16_t it = 0; it < 20000; it++) {
+    // predykcja
+    const double a00 = p00 + 2.0 * ts * p01 + ts * ts * p11 + KF_QT;
+    const double a01 = p01 + ts * p11;
+    const double a11 = p11 + qb;
+    // korekta
+    const double s   = a00 + KF_R;
+    const double n1  = a00 / s, n2 = a01 / s;
+    p00 = (1.0 - n1) * a00;
+    p01 = (1.0 - n1) * a01;
+    p11 = a11 - n2 * a01;
+    const bool done = fabs(n1 - l1) < 1e-12 && fabs(n2 - l2) < 1e-14;
+    l1 = n1; l2 = n2;
+    if (done) break;
+  }
+  _uAlpha = q16FromDouble(ts / (KF_U_TAU_S + ts));
+  _l1 = (int64_t)(l1 * Q32);
+  _l2 = (int64_t)(l2 / ts * Q32);   // b w °C/s – korekta na sekundę kroku
+}
+
+void TempEstimator::configure(const PlantModel& m) {
+  const double ts = _tsMs / 1000.0;
+  if (m.K > 0.0f && m.tauSec > 0.0f) {
+    _cK = (int64_t)(m.K * 100.0 * ts / m.tauSec * Q32);   // u = 1 → 100 %
+    _cT = (int64_t)(ts / m.tauSec * Q32);
+  } else {
+    _cK = _cT = 0;
+  }
+  _amb = (int64_t)(m.ambC * Q32);
+}
+
+void TempEstimator::reset(q16_t tempQ) {
+  _t     = (int64_t)tempQ << 16;
+  _b     = 0;
+  _rateQ = 0;
+  _uf    = 0;
+  _valid = true;
+}
+
+void TempEstimator::update(q16_t measQ, q16_t onFracQ) {
+  if (!_valid) { reset(measQ); return; }
+
+  // predykcja: przyrost z modelu + reszta nachylenia
+  _uf += (q16_t)(((int64_t)(onFracQ - _uf) * _uAlpha) >> 16);
+  const int64_t dev   = (_t - _amb) >> 16;                                // °C Q16
+  const int64_t model = ((_cK * _uf) >> 16) - ((dev * _cT) >> 16);
+  const int64_t drift = _b * (int64_t)_tsMs / 1000;
+  _t += model + drift;
+
+  // korekta stałymi wzmocnieniami; innowacja obcięta (zakłócenie ramki / skok czujnika)
+  int64_t e = (int64_t)measQ - (_t >> 16);
+  if (e >  (int64_t)50 * Q16_ONE) e =  (int64_t)50 * Q16_ONE;
+  if (e < -(int64_t)50 * Q16_ONE) e = -(int64_t)50 * Q16_ONE;
+  _t += (e * _l1) >> 16;
+  _b += (e * _l2) >> 16;
+
+  // nachylenie do PID / UI: model + reszta [°C/s]
+  const int64_t r = (model * 1000 / (int64_t)_tsMs + _b) >> 16;
+  _rateQ = (q16_t)r;
+}
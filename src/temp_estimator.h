@@ -0,0 +1,46 @@
+/***************************************************************************************
+ * FILE: src/temp_estimator.h
+ * LAST MODIFIED: 2026-10-19 20:40 (Europe/Warsaw)
+ * PURPOSE: Estymator temperatury i nachylenia – filtr Kalmana (model + termopara)
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+#include "pid_fixed.h"
+#include "config.h"
+
+// Stan [T, b]: temperatura i „reszta” nachylenia, której model nie tłumaczy.
+//   T[k+1] = T + Ts·((K·u − (T − Tamb))/tau + b),   b[k+1] = b   (+ szum procesu)
+//   y = T + szum (kwantyzacja MAX31855 0.25 °C + szum termopary)
+// u – faktyczny czas włączenia SSR od poprzedniej ramki (0..1), przez filtr 1. rzędu
+// (okno SSR, bezwładność osłony termopary). Bez modelu (K = 0) zostaje model stałej
+// prędkości: b to całe nachylenie.
+// Wzmocnienia stanu ustalonego liczone raz (Riccati w double, w setup) – człon −T/tau
+// przy Ts = 250 ms prawie nie zmienia wzmocnień, więc zmiana modelu ich nie przelicza.
+// Krok filtru: same int64 na Q32.32 – stała liczba operacji, bez float.
+
+class TempEstimator {
+public:
+  void begin(uint32_t tsMs);                 // wzmocnienia dla okresu ramek
+  void configure(const PlantModel& m);       // współczynniki modelu (K = 0 → bez modelu)
+
+  void reset(q16_t tempQ);                   // start od pomiaru, nachylenie 0
+  // co ramkę pomiaru; onFracQ – udział włączenia SSR (Q16.16, 0..1)
+  void update(q16_t measQ, q16_t onFracQ);
+
+  bool  valid()   const { return _valid; }
+  void  invalidate()    { _valid = false; }
+  q16_t temp()    const { return (q16_t)(_t >> 16); }   // °C Q16.16
+  q16_t rate()    const { return _rateQ; }              // °C/s Q16.16
+
+private:
+  bool     _valid = false;
+  uint32_t _tsMs  = 250;
+  int64_t  _t = 0, _b = 0;        // Q32.32: °C, °C/s
+  int64_t  _l1 = 0, _l2 = 0;      // wzmocnienia Q32.32 (L2 w 1/s)
+  int64_t  _cK = 0;               // K·Ts/tau [°C na krok przy u = 1]
+  int64_t  _cT = 0;               // Ts/tau
+  int64_t  _amb = 0;              // Q32.32
+  q16_t    _rateQ = 0;
+  q16_t    _uf = 0;               // przefiltrowany udział włączenia SSR (Q16.16, 0..1)
+  q16_t    _uAlpha = 0;
+};
@@ -0,0 +1,160 @@
+/***************************************************************************************
+ * FILE: src/thermocouple.cpp
+ * LAST MODIFIED: 2026-10-20 04:30 (Europe/Warsaw)
+ * PURPOSE: Linearyzacja termopary typu K wg NIST ITS-90 (tabele constexpr)
+ ***************************************************************************************/
+#include "thermocouple.h"
+#include <math.h>
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Wielomiany NIST ITS-90 (typ K) – używane tylko w czasie kompilacji
+// ────────────────────────────────────────────────────────────────────────────────
+
+// E(T) [mV], T w °C, zakres -270..0 °C
+static constexpr double NIST_FWD_NEG[] = {
+   0.0,
+   3.9450128025e-2,  2.3622373598e-5, -3.2858906784e-7, -4.9904828777e-9,
+  -6.7509059173e-11,-5.7410327428e-13,-3.1088872894e-15,-1.0451609365e-17,
+  -1.9889266878e-20,-1.6322697486e-23
+};
+
+// E(T) [mV], T w °C, zakres 0..1372 °C (+ człon wykładniczy a0·exp(a1·(T-a2)²))
+static constexpr double NIST_FWD_POS[] = {
+  -1.7600413686e-2,
+   3.8921204975e-2,  1.8558770032e-5, -9.9457592874e-8,  3.1840945719e-10,
+  -5.6072844889e-13, 5.6075059059e-16,-3.2020720003e-19, 9.7151147152e-23,
+  -1.2104721275e-26
+};
+static constexpr double NIST_FWD_A0 =  1.185976e-1;
+static constexpr double NIST_FWD_A1 = -1.183432e-4;
+static constexpr double NIST_FWD_A2 =  126.9686;
+
+// T(E) [°C], E w mV – trzy przedziały wielomianu odwrotnego
+static constexpr double NIST_INV_NEG[] = {   // -5.891 .. 0 mV
+   0.0,
+   2.5173462e1, -1.1662878, -1.0833638, -8.9773540e-1,
+  -3.7342377e-1,-8.6632643e-2,-1.0450598e-2,-5.1920577e-4
+};
+static constexpr double NIST_INV_MID[] = {   // 0 .. 20.644 mV
+   0.0,
+   2.508355e1,   7.860106e-2, -2.503131e-1,  8.315270e-2,
+  -1.228034e-2,  9.804036e-4, -4.413030e-5,  1.057734e-6,
+  -1.052755e-8
+};
+static constexpr double NIST_INV_HIGH[] = {  // 20.644 .. 54.886 mV
+  -1.318058e2,
+   4.830222e1,  -1.646031,     5.464731e-2, -9.650715e-4,
+   8.802193e-6, -3.110810e-8
+};
+
+template <size_t N>
+static constexpr double horner(const double (&c)[N], double x) {
+  double acc = 0.0;
+  for (size_t i = N; i > 0; --i) acc = acc * x + c[i - 1];
+  return acc;
+}
+
+// exp() dla constexpr – szereg Taylora; argument członu NIST mieści się w ~[-4, 0]
+static constexpr double cexpSeries(double x) {
+  double sum = 1.0, term = 1.0;
+  for (int n = 1; n < 60; ++n) {
+    term *= x / n;
+    sum  += term;
+  }
+  return sum;
+}
+
+static constexpr double nistForwardMv(double tC) {
+  if (tC < 0.0) return horner(NIST_FWD_NEG, tC);
+  const double d = tC - NIST_FWD_A2;
+  return horner(NIST_FWD_POS, tC) + NIST_FWD_A0 * cexpSeries(NIST_FWD_A1 * d * d);
+}
+
+static constexpr double nistInverseC(double mV) {
+  if (mV < 0.0)    return horner(NIST_INV_NEG, mV);
+  if (mV < 20.644) return horner(NIST_INV_MID, mV);
+  return horner(NIST_INV_HIGH, mV);
+}
+
+static constexpr int32_t roundToI32(double v) {
+  return (int32_t)(v < 0.0 ? v - 0.5 : v + 0.5);
+}
+
+// ────────────────────────────────────────────────────────────────────────────────
+// Tabele liczone w czasie kompilacji
+// ────────────────────────────────────────────────────────────────────────────────
+
+template <size_t N>
+struct TcTable { int32_t v[N]; };
+
+// złącze zimne: -40..128 °C co 4 °C (64 liczniki po 1/16 °C) → napięcie w nV
+static constexpr int32_t CJ_MIN_COUNTS = -40 * 16;
+static constexpr uint8_t CJ_STEP_SHIFT = 6;
+static constexpr size_t  CJ_N          = 43;
+
+static constexpr TcTable<CJ_N> makeCjTable() {
+  TcTable<CJ_N> t{};
+  for (size_t i = 0; i < CJ_N; ++i) {
+    const double tC = (CJ_MIN_COUNTS + (int32_t)(i << CJ_STEP_SHIFT)) / 16.0;
+    t.v[i] = roundToI32(nistForwardMv(tC) * 1e6);
+  }
+  return t;
+}
+
+// odwrotna: od -6.29 mV do ~55.9 mV co 2^19 nV (≈0.524 mV, ≈13 °C) → temperatura w m°C
+static constexpr int32_t INV_V0_NV      = -(12L << 19);
+static constexpr uint8_t INV_STEP_SHIFT = 19;
+static constexpr size_t  INV_N          = 119;
+
+static constexpr TcTable<INV_N> makeInvTable() {
+  TcTable<INV_N> t{};
+  for (size_t i = 0; i < INV_N; ++i) {
+    const double mV = (INV_V0_NV + (int64_t)i * (1L << INV_STEP_SHIFT)) / 1e6;
+    t.v[i] = roundToI32(nistInverseC(mV) * 1000.0);
+  }
+  return t;
+}
+
+static constexpr TcTable<CJ_N>  TC_CJ_NV   = makeCjTable();
+static constexpr TcTable<INV_N> TC_INV_MC  = makeInvTable();
+
+// MAX31855: 41.276 µV/°C → 41276 nV/°C
+static constexpr int32_t MAX31855_NV_PER_C = 41276;
+
+// ────────────────────────────────────────────────────────────────────────────────
+// API
+// ────────────────────────────────────────────────────────────────────────────────
+
+// oba wołane także z przerwania timer1 (nadzór) – IRAM, bez int64 (__muldi3 z flash)
+int32_t IRAM_ATTR tcLinearizeCounts(int16_t tcCounts, int16_t cjCounts) {
+  // napięcie zmierzone przez układ: 41.276 µV/°C × (T_R − T_CJ), w 1/16 °C
+  const int32_t d16   = (int32_t)tcCounts * 4 - cjCounts;
+  const int32_t vMeas = (d16 * MAX31855_NV_PER_C) >> 4;   // |d16| < 35000 → bez przepełnienia
+
+  // napięcie odpowiadające złączu zimnemu (tabela + interpolacja liniowa)
+  int32_t cu = (int32_t)cjCounts - CJ_MIN_COUNTS;
+  if (cu < 0) cu = 0;
+  uint32_t ci = (uint32_t)cu >> CJ_STEP_SHIFT;
+  int32_t  cf = cu - (int32_t)(ci << CJ_STEP_SHIFT);
+  if (ci >= CJ_N - 1) { ci = CJ_N - 2; cf = 1 << CJ_STEP_SHIFT; }
+  const int32_t vCj = TC_CJ_NV.v[ci] +
+                      (((TC_CJ_NV.v[ci + 1] - TC_CJ_NV.v[ci]) * cf) >> CJ_STEP_SHIFT);
+
+  // napięcie całkowite → temperatura (tabela odwrotna + interpolacja liniowa)
+  int32_t u = vMeas + vCj - INV_V0_NV;
+  if (u < 0) u = 0;
+  uint32_t ii = (uint32_t)u >> INV_STEP_SHIFT;
+  int32_t  fr = u - (int32_t)(ii << INV_STEP_SHIFT);
+  if (ii >= INV_N - 1) { ii = INV_N - 2; fr = 1L << INV_STEP_SHIFT; }
+  const int32_t a = TC_INV_MC.v[ii];
+  const int32_t b = TC_INV_MC.v[ii + 1];
+  // |b − a| < 2^17 m°C, fr >> 5 < 2^14 → iloczyn w int32 (ułamek co 32 nV, różnica ≤ 3 m°C)
+  return a + (((b - a) * (fr >> 5)) >> (INV_STEP_SHIFT - 5));
+}
+
+bool IRAM_ATTR tcDecodeFrame(uint32_t raw, int16_t& tcCounts, int16_t& cjCounts) {
+  // D31..D18: termopara (14 bit ze znakiem), D16: fault, D15..D4: złącze zimne (12 bit), D2..D0: OC/SCG/SCV
+  tcCounts = (int16_t)((int32_t)raw >> 18);
+  cjCounts = (int16_t)((int32_t)(raw << 16) >> 20);
+  return (raw & 0x00010007UL) == 0;
+}
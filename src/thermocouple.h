@@ -0,0 +1,22 @@
+/***************************************************************************************
+ * FILE: src/thermocouple.h
+ * LAST MODIFIED: 2026-10-20 02:30 (Europe/Warsaw)
+ * PURPOSE: Linearyzacja termopary typu K wg NIST ITS-90 (korekta odczytu MAX31855)
+ ***************************************************************************************/
+#pragma once
+#include <Arduino.h>
+
+// MAX31855 liczy temperaturę zakładając stałe 41.276 µV/°C, co przy 1050–1250 °C
+// daje błąd kilku stopni. Tu odtwarzamy napięcie termopary (z uwzględnieniem złącza
+// zimnego) i przeliczamy je odwrotnym wielomianem NIST – przez tabele liczone
+// w czasie kompilacji, bez pow()/exp() w runtime.
+
+// surowe liczniki MAX31855:
+//   tcCounts – 14 bitów ze znakiem, LSB = 0.25 °C (temperatura „liniowa” układu)
+//   cjCounts – 12 bitów ze znakiem, LSB = 0.0625 °C (złącze zimne)
+// wynik: skorygowana temperatura gorącego złącza w m°C
+int32_t tcLinearizeCounts(int16_t tcCounts, int16_t cjCounts);
+
+// rozbiór surowej ramki 32-bit MAX31855 (readRaw()): false gdy układ zgłasza błąd
+// (OC/SCG/SCV) – wtedy tcCounts jest bez znaczenia, cjCounts nadal poprawne
+bool tcDecodeFrame(uint32_t raw, int16_t& tcCounts, int16_t& cjCounts);
@@ -1,6 +1,6 @@
 /***************************************************************************************
  * FILE: src/web_config.cpp
- * LAST MODIFIED: 2025-11-14 19:10 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-20 01:40 (Europe/Warsaw)
  * PURPOSE: Strony i API do konfiguracji pinów oraz profili (programów) wypału
  ***************************************************************************************/
 #include <Arduino.h>
@@ -8,9 +8,11 @@
 #include <ArduinoJson.h>
 #include <FS.h>
 #include <LittleFS.h>
+#include <StreamDev.h>   // StreamConstPtr – ciało HTTP jako Stream bez kopiowania
 #include "config.h"
 #include "control.h"   // korzystamy z applyProfileFromJson(...)
 #include "web_config.h"
+#include "storage.h"     // binarny snapshot profilu + planu (/profile.bin)
 #include <vector>
 
 // ────────────────────────────────────────────────────────────────────────────────
@@ -97,7 +99,10 @@ static void applyPinsFromJson(const JsonObject& j){
   if (j.containsKey("SPI_MISO"))P.SPI_MISO= j["SPI_MISO"].as<int>();
   if (j.containsKey("SPI_SCK")) P.SPI_SCK = j["SPI_SCK"].as<int>();
   if (j.containsKey("SPI_CS"))  P.SPI_CS  = j["SPI_CS"].as<int>();
+  if (j.containsKey("SPI_CS2")) P.SPI_CS2 = j["SPI_CS2"].as<int>();
   if (j.containsKey("SSR"))     P.SSR     = j["SSR"].as<int>();
+  if (j.containsKey("SSR2"))    P.SSR2    = j["SSR2"].as<int>();
+  if (j.containsKey("SSR3"))    P.SSR3    = j["SSR3"].as<int>();
   if (j.containsKey("LED"))     P.LED     = j["LED"].as<int>();
   if (j.containsKey("BUZZ"))    P.BUZZ    = j["BUZZ"].as<int>();
 }
@@ -119,18 +124,91 @@ static bool savePinsFS(const JsonObject& j){
 
 // ────────────────────────────────────────────────────────────────────────────────
 // PROFIL: load/save FS + zastosowanie do RAM (applyProfileFromJson z control.cpp)
-bool loadProfileFS(){
 
-  if (!LittleFS.exists(FILE_PROFILE)) return false;
-  File f = LittleFS.open(FILE_PROFILE, "r"); if (!f) return false;
-  StaticJsonDocument<1024> d;
-  auto err = deserializeJson(d, f); f.close();
-  if (err) return false;
+// zastosuj do RAM + odśwież snapshot skompilowanego profilu (także pusty – żeby nie
+// został stary profil przy następnym starcie)
+static bool applyProfileAndStore(Stream& json){
+  bool ok = applyProfileFromJson(json);
+  saveProfile(PROFILE, PROFILE_LEN, PROFILE_PLAN);
+  return ok;
+}
+
+static bool applyProfileFile(const char* path){
+  File f = LittleFS.open(path, "r"); if (!f) return false;
+  bool ok = applyProfileAndStore(f);
+  f.close();
+  return ok;
+}
+
+static bool writeFileFS(const String& path, const String& body){
+  File f = LittleFS.open(path, "w"); if (!f) return false;
+  bool ok = f.write((const uint8_t*)body.c_str(), body.length()) == body.length();
+  f.close();
+  return ok;
+}
+
+static bool copyFileFS(const String& from, const char* to){
+  File src = LittleFS.open(from, "r"); if (!src) return false;
+  File dst = LittleFS.open(to, "w");   if (!dst) { src.close(); return false; }
+  uint8_t buf[128]; bool ok = true;
+  while (ok && src.available()){
+    size_t n = src.read(buf, sizeof(buf));
+    ok = n > 0 && dst.write(buf, n) == n;
+  }
+  src.close(); dst.close();
+  return ok;
+}
+
+// walidacja kroków profilu – strumieniowo, po jednym kroku (bez dużego dokumentu)
+struct ProfileCheck { const char* err; uint16_t steps; uint16_t segs; };
 
-  JsonArray steps = d["steps"].as<JsonArray>();
-  if (steps.isNull()) return false;
+static bool checkProfileStep(JsonObject s, void* ctx){
+  ProfileCheck& c = *(ProfileCheck*)ctx;
+  double t = s["targetC"] | NAN;
+  uint32_t hold = s["holdSec"] | 0;
+  if (!isfinite(t) || t < 0 || t > 2000){ c.err = "bad temp"; return false; }
 
-  bool ok = applyProfileFromJson(steps);
+  if (hold > 72UL*3600UL){ c.err = "max 72h"; return false; }
+
+  // rampy w °C/h, 0 = skok zadanej
+  uint32_t up = s["rampCph"] | 0, down = s["rampDownCph"] | 0;
+  if (up > 9999 || down > 9999){ c.err = "bad ramp"; return false; }
+
+  // gwarantowane wytrzymanie: pasmo ±°C i maks. czekanie w minutach
+  uint32_t band = s["bandC"] | 0, wait = s["maxWaitMin"] | 0;
+  if (band > 255 || wait > 65535){ c.err = "bad band"; return false; }
+
+  // koniec holdu po pracy cieplnej: nazwa stożka Orton ("06", "6"), pusta = brak
+  const char* cone = s["cone"] | "";
+  if (*cone && coneFromName(cone) < 0){ c.err = "bad cone"; return false; }
+
+  // pula segmentów planu: hold + ewentualnie rampa
+  c.steps++;
+  c.segs += (up || down) ? 2 : 1;
+  if (c.steps > PROFILE_MAX_STEPS || c.segs > PLAN_MAX_SEGS){ c.err = "max 64 segments"; return false; }
+  return true;
+}
+
+// nullptr = OK, inaczej kod błędu do {"error":...}
+static const char* validateProfileBody(const String& body){
+  ProfileCheck c = { nullptr, 0, 0 };
+  StreamConstPtr in(body.c_str(), body.length());
+  if (profileJsonForEach(in, checkProfileStep, &c)) return nullptr;
+  if (c.err) return c.err;
+  return (body.indexOf("\"steps\"") < 0) ? "missing steps" : "bad json";
+}
+
+static void sendError(int code, const char* err){
+  String out = String("{\"error\":\"") + err + "\"}";
+  sendCORS(); g_srv->send(code,"application/json",out);
+}
+
+bool loadProfileFS(){
+  // najpierw snapshot binarny – bez parsowania JSON i kompilacji
+  if (applyProfileFromStorage()) return true;
+
+  if (!LittleFS.exists(FILE_PROFILE)) return false;
+  bool ok = applyProfileFile(FILE_PROFILE);
   if (ok) {
     CFG.mode = MODE_PROFILE;
     cfgSave();
@@ -138,21 +216,11 @@ bool loadProfileFS(){
   return ok;
 }
 
-static bool saveProfileFS(const JsonArray& steps){
-  StaticJsonDocument<1024> d;
-  JsonArray out = d.createNestedArray("steps");
-  uint8_t n = 0;
-  for (JsonObject s : steps){
-    if (n >= 8) break;
-    JsonObject o = out.createNestedObject();
-    o["targetC"] = s["targetC"] | 0;
-    o["holdSec"] = s["holdSec"] | 0;
-    n++;
-  }
-  File f = LittleFS.open(FILE_PROFILE, "w"); if (!f) return false;
-  serializeJson(d, f); f.close();
+// body już zwalidowane – zapis 1:1 i zastosowanie z pliku
+static bool saveProfileFS(const String& body){
+  if (!writeFileFS(FILE_PROFILE, body)) return false;
   // zastosuj do RAM
-  bool ok = applyProfileFromJson(out);
+  bool ok = applyProfileFile(FILE_PROFILE);
   if (ok){
     CFG.mode = MODE_PROFILE;
     cfgSave();
@@ -179,26 +247,32 @@ static void handlePinsJson(){
   d["I2C_SDA"]=P.I2C_SDA; d["I2C_SCL"]=P.I2C_SCL;
   d["SPI_MOSI"]=P.SPI_MOSI; d["SPI_MISO"]=P.SPI_MISO; d["SPI_SCK"]=P.SPI_SCK; d["SPI_CS"]=P.SPI_CS;
   d["SSR"]=P.SSR; d["LED"]=P.LED; d["BUZZ"]=P.BUZZ;
+  d["SSR2"]=P.SSR2; d["SSR3"]=P.SSR3; d["SPI_CS2"]=P.SPI_CS2;
   String out; serializeJson(d,out); sendCORS(); g_srv->send(200,"application/json",out);
 }
 
 static void handlePinsSave(){
   if (g_srv->method()==HTTP_OPTIONS){ opt204(); return; }
-  StaticJsonDocument<384> d;
+  StaticJsonDocument<448> d;
   DeserializationError err = deserializeJson(d, g_srv->arg("plain"));
   if (err){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"bad json\"}"); return; }
 
   // walidacja + kolizje
-  const char* keys[9]={"I2C_SDA","I2C_SCL","SPI_MOSI","SPI_MISO","SPI_SCK","SPI_CS","SSR","LED","BUZZ"};
-  int vals[9];
-  for (int i=0;i<9;i++){
-    if (!d.containsKey(keys[i])){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"missing field\"}"); return; }
+  // SSR2/SSR3 (dodatkowe sekcje grzałek) i SPI_CS2 (termopara przy wyrobie) opcjonalne –
+  // starszy klient ich nie wysyła
+  const char* keys[12]={"I2C_SDA","I2C_SCL","SPI_MOSI","SPI_MISO","SPI_SCK","SPI_CS","SSR","LED","BUZZ","SSR2","SSR3","SPI_CS2"};
+  int vals[12];
+  for (int i=0;i<12;i++){
+    if (!d.containsKey(keys[i])){
+      if (i >= 9){ d[keys[i]] = -1; vals[i] = -1; continue; }
+      sendCORS(); g_srv->send(400,"application/json","{\"error\":\"missing field\"}"); return;
+    }
     int g = d[keys[i]].as<int>();
     if (!isInList(g)){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"gpio out of list\"}"); return; }
     vals[i]=g;
   }
-  for (int i=0;i<9;i++){
-    for (int j=i+1;j<9;j++){
+  for (int i=0;i<12;i++){
+    for (int j=i+1;j<12;j++){
       // -1 = "Brak" – może się powtarzać, nie traktujemy tego jako kolizję
       if (vals[i] >= 0 && vals[i] == vals[j]){
         sendCORS();
@@ -223,37 +297,33 @@ static void handlePinsSave(){
 static void handleProfileHtml(){ sendCORS(); g_srv->send_P(200,"text/html; charset=utf-8",PROFILE_HTML); }
 
 static void handleProfileJson(){
-  StaticJsonDocument<1024> d;
-  JsonArray a = d.createNestedArray("steps");
+  // do 64 kroków – serializujemy krok po kroku małym dokumentem
+  String out; out.reserve(32 + PROFILE_LEN * 128);
+  out += F("{\"steps\":[");
   for (uint8_t i=0;i<PROFILE_LEN;i++){
-    JsonObject o = a.createNestedObject();
+    StaticJsonDocument<192> o;
     o["targetC"] = PROFILE[i].targetC;
     o["holdSec"] = PROFILE[i].holdSec;
+    o["rampCph"]     = PROFILE[i].rampCph;
+    o["rampDownCph"] = PROFILE[i].rampDownCph;
+    o["bandC"]       = PROFILE[i].bandC;
+    o["maxWaitMin"]  = PROFILE[i].maxWaitMin;
+    if (PROFILE[i].cone) o["cone"] = coneName(PROFILE[i].cone - 1);
+    if (i) out += ',';
+    serializeJson(o, out);
   }
-  String out; serializeJson(d,out);
+  out += F("]}");
   sendCORS(); g_srv->send(200,"application/json",out);
 }
 
 static void handleProfileSave(){
   if (g_srv->method()==HTTP_OPTIONS){ opt204(); return; }
-  StaticJsonDocument<1024> d;
-  DeserializationError err = deserializeJson(d, g_srv->arg("plain"));
-  if (err){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"bad json\"}"); return; }
-  JsonArray steps = d["steps"].as<JsonArray>();
-  if (steps.isNull()){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"missing steps\"}"); return; }
-  if (steps.size() > 8){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"max 8\"}"); return; }
-
-  // prosta walidacja
-  for (JsonObject s : steps){
-    double t = s["targetC"] | NAN;
-    uint32_t hold = s["holdSec"] | 0;
-    if (!isfinite(t) || t < 0 || t > 2000){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"bad temp\"}"); return; }
-
-    if (hold > 72UL*3600UL){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"max 72h\"}"); return; }
-  }
+  const String& body = g_srv->arg("plain");
+  const char* err = validateProfileBody(body);
+  if (err){ sendError(400, err); return; }
 
   if (!LittleFS.exists("/")) LittleFS.begin();
-  if (!saveProfileFS(steps)){ sendCORS(); g_srv->send(500,"application/json","{\"error\":\"fs write\"}"); return; }
+  if (!saveProfileFS(body)){ sendCORS(); g_srv->send(500,"application/json","{\"error\":\"fs write\"}"); return; }
 
   sendCORS(); g_srv->send(200,"application/json","{\"ok\":true}");
 }
@@ -265,18 +335,9 @@ static bool loadNamedProfile(const String& name){
   String fn = String(DIR_PROFILES) + "/" + name + ".json";
   if (!LittleFS.exists(fn)) return false;
 
-  File f = LittleFS.open(fn, "r"); if (!f) return false;
-  StaticJsonDocument<1024> d;
-  auto err = deserializeJson(d, f); f.close();
-  if (err) return false;
-
-  JsonArray steps = d["steps"].as<JsonArray>();
-  if (steps.isNull()) return false;
-
   // ustaw jako aktywny + zastosuj
-  File fa = LittleFS.open(FILE_PROFILE, "w");
-  if (fa) { serializeJson(d, fa); fa.close(); }
-  bool ok = applyProfileFromJson(steps);
+  if (!copyFileFS(fn, FILE_PROFILE)) return false;
+  bool ok = applyProfileFile(FILE_PROFILE);
   if (ok){
     CFG.mode = MODE_PROFILE;
     cfgSave();
@@ -284,26 +345,18 @@ static bool loadNamedProfile(const String& name){
   return ok;
 }
 
-static bool saveNamedProfile(const String& name, const JsonArray& steps){
+// body już zwalidowane
+static bool saveNamedProfile(const String& name, const String& body){
   if (!LittleFS.begin()) LittleFS.begin();
   ensureDir(DIR_PROFILES);
   String fn = String(DIR_PROFILES) + "/" + name + ".json";
 
-  StaticJsonDocument<1024> d;
-  JsonArray out = d.createNestedArray("steps");
-  for (JsonObject s : steps){
-    JsonObject o = out.createNestedObject();
-    o["targetC"] = s["targetC"] | 0;
-    o["holdSec"] = s["holdSec"] | 0;
-  }
-  File f = LittleFS.open(fn, "w"); if (!f) return false;
-  serializeJson(d, f); f.close();
+  if (!writeFileFS(fn, body)) return false;
 
   // uczyń aktywnym
-  File fa = LittleFS.open(FILE_PROFILE, "w");
-  if (fa) { serializeJson(d, fa); fa.close(); }
+  writeFileFS(FILE_PROFILE, body);
 
-  bool ok = applyProfileFromJson(out);
+  bool ok = applyProfileFile(FILE_PROFILE);
   if (ok){
     CFG.mode = MODE_PROFILE;
     cfgSave();
@@ -330,11 +383,10 @@ static void handleProfilesSave(){
   if (g_srv->method()==HTTP_OPTIONS){ opt204(); return; }
   if(!g_srv->hasArg("name")){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"missing name\"}"); return; }
   String name = g_srv->arg("name");
-  StaticJsonDocument<1024> d;
-  if (deserializeJson(d, g_srv->arg("plain"))) { sendCORS(); g_srv->send(400,"application/json","{\"error\":\"bad json\"}"); return; }
-  JsonArray steps = d["steps"].as<JsonArray>();
-  if (steps.isNull()){ sendCORS(); g_srv->send(400,"application/json","{\"error\":\"missing steps\"}"); return; }
-  if (!saveNamedProfile(name, steps)){ sendCORS(); g_srv->send(500,"application/json","{\"error\":\"fs write\"}"); return; }
+  const String& body = g_srv->arg("plain");
+  const char* err = validateProfileBody(body);
+  if (err){ sendError(400, err); return; }
+  if (!saveNamedProfile(name, body)){ sendCORS(); g_srv->send(500,"application/json","{\"error\":\"fs write\"}"); return; }
   sendCORS(); g_srv->send(200,"application/json","{\"ok\":true}");
 }
 
@@ -1,6 +1,6 @@
 /***************************************************************************************
  * FILE: src/webserver.cpp
- * LAST MODIFIED: 2025-11-15 03:40 (Europe/Warsaw)
+ * LAST MODIFIED: 2026-10-20 05:20 (Europe/Warsaw)
  * PURPOSE: ESP8266 WebServer – SoftAP (open), panel mobilny, /ping + wykres z osiami
  ***************************************************************************************/
 #include "webserver.h"
@@ -194,6 +194,9 @@ static String buildStatusJson(){
   j += F("\"temp_c\":");   j += (isfinite(KILN_TEMP)?String(KILN_TEMP,1):F("null")); j += F(",");
   j += F("\"set_c\":");    j += String(PID_SET,1);                               j += F(",");
   j += F("\"duty_pct\":"); j += String(PID_OUT,1);
+  if (CFG.mode == MODE_PROFILE && PROFILE_ETA_SEC != PROFILE_ETA_UNKNOWN) {
+    j += F(",\"eta_s\":"); j += String(PROFILE_ETA_SEC);   // do końca programu
+  }
   j += F("}");
   return j;
 }
@@ -202,8 +205,16 @@ static String buildStatusJson(){
 static void handleIndex(){ sendCORS(); server.send_P(200,"text/html; charset=utf-8",INDEX_HTML); }
 static void handlePing(){  sendCORS(); server.send(200,"text/plain","pong"); }
 
+// /state – pojemność ze schematu (sterta, nie stos cont ~4 KB): 22 pola + 7 profilu +
+// 6 obiektów; ssr 6, energy 2, heatwork 2, loop 7, ap 3, sta 4; kopie String z WiFi
+// (SSID ≤ 32, IP, MAC) dla ap i sta
+static const size_t STATE_JSON_CAP =
+    JSON_OBJECT_SIZE(22 + 7 + 6) + JSON_OBJECT_SIZE(6) + JSON_OBJECT_SIZE(2) +
+    JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(7) + JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(4) +
+    2 * (33 + 16 + 18);
+
 static void handleState() {
-  StaticJsonDocument<512> d;
+  DynamicJsonDocument d(STATE_JSON_CAP);
 
   double temp = KILN_TEMP;
   bool sensorOK = isfinite(temp);
@@ -211,13 +222,29 @@ static void handleState() {
 
   d["active"] = RUN_ACTIVE;
   d["safety"] = SAFETY_TRIP;
+  if (SAFETY_TRIP) d["trip"] = safetyTripName(SAFETY_REASON);   // overtemp / relay / no_heat / board
   d["heater"] = HEATER_ON;
   d["sensor"] = sensorOK;
   d["temp"]   = temp;  // piec
+  d["temp_est"] = isfinite(KILN_TEMP_EST) ? KILN_TEMP_EST : NAN;  // estymata Kalmana
+  d["rate"]   = KILN_RATE_CPH;   // °C/h
   d["ctrl_temp"] = isfinite(CTRL_TEMP) ? CTRL_TEMP : NAN;  // sterownik
+  if (isfinite(WARE_TEMP))  d["ware"]      = WARE_TEMP;    // termopara przy wyrobie
+  if (isfinite(CASCADE_SP)) d["inner_set"] = CASCADE_SP;   // kaskada: zadana przy grzałkach
   d["set"]    = isfinite(PID_SET) ? PID_SET : 0;
   d["out"]    = isfinite(PID_OUT) ? PID_OUT : 0;
-  d["mode"]   = (CFG.mode == MODE_PROFILE) ? "profile" : "dynamic";
+  d["ff"]     = PID_FF;   // część wyjścia z feed-forward
+  d["pred"]   = PID_PRED; // korekta predyktora Smitha [°C]
+  d["mode"]   = (CFG.mode == MODE_PROFILE)  ? "profile"
+              : (CFG.mode == MODE_AUTOTUNE) ? "autotune" : "dynamic";
+  d["tick_cyc"]     = CTRL_TICK_CYCLES;      // benchmark pętli sterowania
+  d["tick_cyc_max"] = CTRL_TICK_CYCLES_MAX;
+  d["pid_cyc"]      = CTRL_PID_CYCLES;       // sam krok PID (porównanie FixedPID / PID_v1 na ESP)
+  d["pid_cyc_max"]  = CTRL_PID_CYCLES_MAX;
+  d["tick_over"]    = CTRL_TICK_OVERRUNS;    // ticki ponad termin (nie karmią watchdoga)
+  d["starve_n"]     = CTRL_STARVE_N;         // grzałki zgaszone przez watchdog sterowania
+  d["starve_max"]   = CTRL_STARVE_MAX_MS;
+  d["q_drop"]       = THERMO_Q_DROPPED;      // ramki MAX31855 utracone przy pełnej kolejce
 
   // dane profilu – krok + czasy etapu (sekundy)
   if (CFG.mode == MODE_PROFILE) {
@@ -225,8 +252,43 @@ static void handleState() {
     d["steps"]           = PROFILE_LEN;
     d["profile_elapsed"] = PROFILE_ELAPSED_SEC;
     d["profile_remain"]  = PROFILE_REMAIN_SEC;
+    d["phase"]           = profilePhaseName(PROFILE_PHASE);   // ramp / wait / hold
+    if (PROFILE_ETA_SEC != PROFILE_ETA_UNKNOWN) d["eta"] = PROFILE_ETA_SEC;   // cały program [s]
+    if (PROFILE_COOL_LAG) d["cool_lag"] = true;   // rampa studzenia czeka na stygnący piec
+  }
+
+  // modulacja SSR – strategia, licznik przełączeń, sekcje grzałek (włączone / limit)
+  JsonObject ssr = d.createNestedObject("ssr");
+  ssr["mod"]      = ssrModName(CFG.pid.ssrMod);
+  ssr["period"]   = CFG.pid.windowMs;
+  ssr["switches"] = SSR_SWITCHES;
+  ssr["banks"]    = SSR_BANKS;
+  ssr["on"]       = SSR_BANKS_ON;
+  ssr["max_on"]   = SSR_BANKS_MAX_ON;
+
+  // energia bieżącego (ostatniego) RUN i kroku profilu [Wh]
+  JsonObject en = d.createNestedObject("energy");
+  en["run_wh"] = energyRunWh();
+  if (CFG.mode == MODE_PROFILE) en["step_wh"] = energyStepWh(PROFILE_ACTIVE);
+
+  // praca cieplna RUN – temperatura ekwiwalentna rampy 60 °C/h i najwyższy dojrzały stożek
+  if (HEAT_TEQ_MILLI) {
+    JsonObject hw = d.createNestedObject("heatwork");
+    hw["teq"] = HEAT_TEQ_MILLI / 1000;
+    if (HEAT_CONE >= 0) hw["cone"] = coneName(HEAT_CONE);
   }
 
+  // nadzór pętli – werdykt ostatniej oceny + korekty adaptacji
+  const LoopMonitor& lm = loopMonitorInfo();
+  JsonObject loop = d.createNestedObject("loop");
+  loop["health"] = loopHealthName(lm.health());
+  loop["amp"]    = q16ToDouble(lm.stats().ampQ);
+  loop["period"] = lm.stats().periodMs / 1000UL;
+  loop["adapt"]  = CFG.pid.adapt;
+  loop["kp_mul"] = LOOP_KP_MUL;
+  loop["ki_mul"] = LOOP_KI_MUL;
+  loop["adj"]    = LOOP_ADAPT_N;
+
   // ─────────────────────────────────────────────
   // INFO O SIECI – AP (zawsze) + STA (opcjonalnie)
   // ─────────────────────────────────────────────
@@ -270,7 +332,7 @@ static void handleProfilePrev() {
 
 // Aktualizacja handlePins() – pełne mapowanie GPIO + "Brak" dla -1
 static void handlePins(){
-  StaticJsonDocument<768> d; JsonArray a = d.to<JsonArray>();
+  StaticJsonDocument<896> d; JsonArray a = d.to<JsonArray>();
 
   struct Item{ const char* role; int gpio; };
   Item items[] = {
@@ -280,7 +342,10 @@ static void handlePins(){
     {"SPI_MISO",CFG.pins.SPI_MISO},
     {"SPI_SCK",CFG.pins.SPI_SCK},
     {"SPI_CS",CFG.pins.SPI_CS},
+    {"SPI_CS2",CFG.pins.SPI_CS2},
     {"SSR",CFG.pins.SSR},
+    {"SSR2",CFG.pins.SSR2},
+    {"SSR3",CFG.pins.SSR3},
     {"LED",CFG.pins.LED},
     {"BUZZ",CFG.pins.BUZZ},
   };
@@ -303,9 +368,19 @@ static void handlePins(){
   server.send(200,"application/json",out);
 }
 
+// zadziałanie nadzoru jest zatrzaśnięte – start dopiero po POST /safety/ack
+static bool refuseOnTrip(){
+  if (!SAFETY_TRIP) return false;
+  const char* why = safetyTripName(SAFETY_REASON);
+  Serial.printf("[HTTP] start refused – safety trip (%s) not acknowledged\n", why);
+  sendCORS();
+  server.send(409,"application/json",String(F("{\"error\":\"trip\",\"reason\":\"")) + why + F("\"}"));
+  return true;
+}
+
 static void handleStart(){
   Serial.println(F("[HTTP] /start"));
-  SAFETY_TRIP=false;
+  if (refuseOnTrip()) return;
   runStart();
   sendCORS();
   server.send(200,"application/json","{\"ok\":true}");
@@ -318,6 +393,150 @@ static void handleStop(){
   server.send(200,"application/json","{\"ok\":true}");
 }
 
+// POST /safety/ack – świadome potwierdzenie zadziałania nadzoru (przekaźnik, sterownik…);
+// jeśli przyczyna trwa, nadzór zadziała ponownie przy następnej próbce
+static void handleSafetyAck(){
+  Serial.println(F("[HTTP] /safety/ack"));
+  safetyReset();
+  sendCORS();
+  server.send(200,"application/json","{\"ok\":true}");
+}
+
+// ── AUTOTUNE ─────────────────────────────────────────────────────────────────
+// POST /autotune/start?sp=..&hyst=..  – eksperyment przekaźnikowy (RUN w MODE_AUTOTUNE)
+static void handleAutotuneStart(){
+  if (!server.hasArg("sp")) {
+    sendCORS();
+    server.send(400,"application/json","{\"error\":\"missing sp\"}");
+    return;
+  }
+  String raw = server.arg("sp");
+  raw.replace(',', '.');
+  const double sp = atof(raw.c_str());
+  double hyst = 1.0;   // ±1 °C – ponad szum termopary
+  if (server.hasArg("hyst")) {
+    raw = server.arg("hyst");
+    raw.replace(',', '.');
+    hyst = atof(raw.c_str());
+  }
+  if (!(sp > 0 && sp <= CFG.maxTempC) || !(hyst >= 0 && hyst <= 20)) {
+    sendCORS();
+    server.send(400,"application/json","{\"error\":\"range sp 0..maxTemp, hyst 0..20\"}");
+    return;
+  }
+
+  Serial.printf("[HTTP] /autotune/start sp=%.0f hyst=%.1f\n", sp, hyst);
+  if (refuseOnTrip()) return;
+  if (!autotuneStart(sp, hyst)) {
+    sendCORS();
+    server.send(409,"application/json","{\"error\":\"cannot start\"}");
+    return;
+  }
+  sendCORS();
+  server.send(200,"application/json","{\"ok\":true}");
+}
+
+// GET /autotune – stan eksperymentu i wynik
+static void handleAutotune(){
+  static const char* const AT_STATE[] = {"idle", "running", "done", "failed"};
+  const RelayAutotune& at = autotuneInfo();
+  StaticJsonDocument<256> d;
+  d["state"]  = AT_STATE[at.state() & 3];
+  d["cycles"] = at.cycles();
+  d["sp"]     = q16ToDouble(at.setpoint());
+  if (at.state() == AT_FAILED) d["error"] = at.error();
+  if (at.state() == AT_DONE) {
+    const AutotuneResult& r = at.result();
+    d["Ku"] = r.Ku;  d["Pu"] = r.PuSec;
+    d["Kp"] = r.Kp;  d["Ki"] = r.Ki;  d["Kd"] = r.Kd;
+  }
+  String out; serializeJson(d,out);
+  sendCORS();
+  server.send(200,"application/json",out);
+}
+
+// POST /autotune/apply – wynik do CFG.pid (+ zapis)
+static void handleAutotuneApply(){
+  if (!autotuneApply()) {
+    sendCORS();
+    server.send(400,"application/json","{\"error\":\"no result\"}");
+    return;
+  }
+  sendCORS();
+  server.send(200,"application/json","{\"ok\":true}");
+}
+
+// ── MODEL OBIEKTU ────────────────────────────────────────────────────────────
+// GET /model – model identyfikowany w locie + który model jest w użyciu
+static void handleModel(){
+  const PlantIdentifier& id = plantIdInfo();
+  StaticJsonDocument<768> d;
+  d["valid"]   = id.valid();
+  d["online"]  = CFG.modelOnline;
+  d["source"]  = (CFG.modelOnline && id.valid()) ? "online" : "manual";
+  d["updates"] = id.updates();
+  if (id.valid()) {
+    const PlantModel& m = id.model();
+    d["K"]     = m.K;
+    d["tau"]   = m.tauSec;
+    d["theta"] = m.deadSec;
+    d["amb"]   = m.ambC;
+    d["rms"]   = id.rmsC();   // błąd predykcji na krok [°C]
+  }
+  // bank opóźnień – błąd predykcji każdego estymatora
+  JsonArray bank = d.createNestedArray("bank");
+  for (uint8_t i = 0; i < PLANT_BANK; i++) {
+    JsonObject o = bank.createNestedObject();
+    o["theta"] = id.rls(i).delay * (PLANT_TS_MS / 1000UL);
+    o["rms"]   = sqrt(id.rls(i).err) * 100.0;
+  }
+  JsonObject man = d.createNestedObject("manual");
+  man["K"]     = CFG.model.K;
+  man["tau"]   = CFG.model.tauSec;
+  man["theta"] = CFG.model.deadSec;
+  man["amb"]   = CFG.model.ambC;
+
+  String out; serializeJson(d,out);
+  sendCORS();
+  server.send(200,"application/json",out);
+}
+
+// POST /model/save – zidentyfikowany model jako ręczny (przetrwa restart)
+static void handleModelSave(){
+  Serial.println(F("[HTTP] /model/save"));
+  if (!plantModelSave()) {
+    sendCORS();
+    server.send(400,"application/json","{\"error\":\"model not identified\"}");
+    return;
+  }
+  sendCORS();
+  server.send(200,"application/json","{\"ok\":true}");
+}
+
+// POST /model/reset – identyfikacja od zera
+static void handleModelReset(){
+  Serial.println(F("[HTTP] /model/reset"));
+  plantModelReset();
+  sendCORS();
+  server.send(200,"application/json","{\"ok\":true}");
+}
+
+// podsumowanie energii RUN – całość + kroki profilu [Wh]
+static void handleEnergy(){
+  DynamicJsonDocument d(JSON_OBJECT_SIZE(6) + JSON_ARRAY_SIZE(PROFILE_MAX_STEPS));
+  d["active"] = RUN_ACTIVE;
+  d["bank_w"] = CFG.heat.bankW;   // 0 = moc sekcji nieustawiona – liczniki stoją
+  d["banks"]  = SSR_BANKS;
+  d["sec"]    = energyRunSec();
+  d["wh"]     = energyRunWh();
+  JsonArray st = d.createNestedArray("steps");
+  for (uint8_t i = 0; i < PROFILE_LEN; i++) st.add(energyStepWh(i));
+
+  String out; serializeJson(d,out);
+  sendCORS();
+  server.send(200,"application/json",out);
+}
+
 static void handleSet(){
   if (!server.hasArg("sp")) {
     sendCORS();
@@ -697,6 +916,7 @@ void webserverSetup() {
 
   server.on("/start",       HTTP_GET,     handleStart);
   server.on("/stop",        HTTP_GET,     handleStop);
+  server.on("/safety/ack",  HTTP_POST,    handleSafetyAck);
   server.on("/set",         HTTP_ANY,     handleSet);
 
   server.on("/presets",     HTTP_GET,     handlePresets);
@@ -711,6 +931,16 @@ void webserverSetup() {
   server.on("/profile/next", HTTP_POST,   handleProfileNext);
   server.on("/profile/prev", HTTP_POST,   handleProfilePrev);
 
+  server.on("/autotune",       HTTP_GET,  handleAutotune);
+  server.on("/autotune/start", HTTP_POST, handleAutotuneStart);
+  server.on("/autotune/apply", HTTP_POST, handleAutotuneApply);
+
+  server.on("/model",        HTTP_GET,  handleModel);
+  server.on("/model/save",   HTTP_POST, handleModelSave);
+  server.on("/model/reset",  HTTP_POST, handleModelReset);
+
+  server.on("/energy",       HTTP_GET,  handleEnergy);
+
   server.on("/export",      HTTP_GET,     handleExport);
 
   // Konfiguracja WiFi / MQTT (stuby + .html pod linki z UI)
@@ -734,6 +964,7 @@ void webserverSetup() {
   server.on("/pins",          HTTP_OPTIONS, opt204);
   server.on("/start",         HTTP_OPTIONS, opt204);
   server.on("/stop",          HTTP_OPTIONS, opt204);
+  server.on("/safety/ack",    HTTP_OPTIONS, opt204);
   server.on("/set",           HTTP_OPTIONS, opt204);
   server.on("/presets",       HTTP_OPTIONS, opt204);
   server.on("/preset",        HTTP_OPTIONS, opt204);
@@ -746,6 +977,16 @@ void webserverSetup() {
   server.on("/profile/next",  HTTP_OPTIONS, opt204);
   server.on("/profile/prev",  HTTP_OPTIONS, opt204);
 
+  server.on("/autotune",       HTTP_OPTIONS, opt204);
+  server.on("/autotune/start", HTTP_OPTIONS, opt204);
+  server.on("/autotune/apply", HTTP_OPTIONS, opt204);
+
+  server.on("/model",          HTTP_OPTIONS, opt204);
+  server.on("/model/save",     HTTP_OPTIONS, opt204);
+  server.on("/model/reset",    HTTP_OPTIONS, opt204);
+
+  server.on("/energy",         HTTP_OPTIONS, opt204);
+
   server.on("/export",        HTTP_OPTIONS, opt204);
 
   server.on("/wifi",          HTTP_OPTIONS, opt204);
@@ -242,6 +242,7 @@ static const char INDEX_HTML[] PROGMEM = R"HTML(
   <div class="row top-row">
     <button class="start btn-3d" onclick="doStart()">START</button>
     <button class="stop btn-3d"  onclick="doStop()">STOP</button>
+    <button id="btnAck" class="btn" onclick="doAck()" style="display:none" title="potwierdź zadziałanie nadzoru">Kasuj TRIP</button>
     <button class="btn" onclick="fetchState()">Odśwież</button>
 
     <span class="mut" style="margin-left:auto;display:flex;align-items:center;gap:8px">
@@ -276,6 +277,8 @@ static const char INDEX_HTML[] PROGMEM = R"HTML(
       <div>
         <span id="temp" class="temp-main">?</span>
         <span class="temp-unit">°C</span>
+        <span id="rate" class="mut"></span>
+        <span id="ware" class="mut"></span>
         <span id="sensorMsg" class="mut"></span>
       </div>
 
@@ -295,6 +298,8 @@ static const char INDEX_HTML[] PROGMEM = R"HTML(
       <div>
         <span id="out">?</span> %
         <span id="heaterTxt" class="heater-off">HEAT OFF</span>
+        <span id="energy" class="mut"></span>
+        <span id="heatWork" class="mut"></span>
       </div>
 
     </div>
@@ -396,7 +401,7 @@ static const char INDEX_HTML[] PROGMEM = R"HTML(
         <div>API</div>
         <div class="mut" style="font-size:12px">
           Endpointy dla integracji (np. z innym systemem): <code>/ping</code>, <code>/state</code>, <code>/status.json</code>,
-          <code>/mode?m=dynamic|profile</code>, <code>/start</code>/<code>/stop</code>,
+          <code>/mode?m=dynamic|profile</code>, <code>/start</code>/<code>/stop</code>, <code>/safety/ack</code> (POST),
           <code>/set?sp=200</code>, <code>/presets</code>, <code>/preset?i=0</code>, <code>/export</code>.
         </div>
       </div>
@@ -477,7 +482,9 @@ async function fetchState(){
         const remain  = d.profile_remain;
         const total   = elapsed + remain;
         stepTimeEl.style.display = '';
-        stepTimeEl.textContent = 'czas kroku: ' + formatDuration(total) + ' (pozostało: ' + formatDuration(remain) + ')';
+        stepTimeEl.textContent = 'czas kroku: ' + formatDuration(total) + ' (pozostało: ' + formatDuration(remain) + ')'
+          + (typeof d.eta === 'number' ? ' · program: ' + formatDuration(d.eta) : '')
+          + (d.cool_lag ? ' · piec stygnie wolniej niż rampa' : '');
       } else {
         stepTimeEl.style.display = 'none';
         stepTimeEl.textContent = '';
@@ -492,9 +499,18 @@ async function fetchState(){
     }
 
     qs('#temp').textContent   = Number.isFinite(d.temp)? d.temp.toFixed(1) : '?';
+    qs('#rate').textContent   = (d.sensor && Number.isFinite(d.rate))
+      ? ((d.rate >= 0 ? '+' : '') + d.rate.toFixed(0) + ' °C/h') : '';
+    qs('#ware').textContent   = (typeof d.ware === 'number')
+      ? ('wyrób ' + d.ware.toFixed(1) + ' °C' + (typeof d.inner_set === 'number'
+        ? ' · grzałki → ' + d.inner_set.toFixed(0) + ' °C' : '')) : '';
     qs('#set').textContent    = (d.set ?? 0).toFixed(0);
     qs('#out').textContent    = (d.out ?? 0).toFixed(0);
     qs('#bar').style.width    = Math.max(0,Math.min(100,d.out||0))+'%';
+    qs('#energy').textContent = (d.energy && d.energy.run_wh)
+      ? ((d.energy.run_wh / 1000).toFixed(2) + ' kWh') : '';
+    qs('#heatWork').textContent = d.heatwork
+      ? ('stożek ' + (d.heatwork.cone || '–') + ' (Teq ' + d.heatwork.teq + ' °C)') : '';
 
     const ctrlEl = qs('#ctrlTemp');
     if (ctrlEl) {
@@ -518,9 +534,10 @@ async function fetchState(){
     const runOn      = !!d.active;
     const runSpan    = qs('#runStatus');
     if (runSpan) {
-      runSpan.textContent = runOn ? 'ON' : 'OFF';
+      runSpan.textContent = runOn ? 'ON' : (d.safety ? ('TRIP ' + (d.trip || '')) : 'OFF');
       runSpan.className   = runOn ? 'status-on' : 'status-off';
     }
+    qs('#btnAck').style.display = d.safety ? '' : 'none';
 
     const btnStart = qs('.start');
     if (btnStart) {
@@ -620,7 +637,15 @@ function drawChart(){
   x.fillText('czas ('+lbl+')', padL+PW/2, H-4);
 }
 
-function doStart(){ fetch('/start').then(fetchState); }
+function doStart(){
+  fetch('/start').then(r=>r.ok ? null : r.json().then(e=>{
+    if (e.error==='trip') alert('Start zablokowany – zadziałał nadzór ('+e.reason+'). Usuń przyczynę i użyj „Kasuj TRIP”.');
+  })).catch(()=>{}).then(fetchState);
+}
+function doAck(){
+  if (!confirm('Potwierdzić zadziałanie nadzoru? Jeśli przyczyna trwa, zadziała ponownie.')) return;
+  fetch('/safety/ack',{method:'POST'}).then(fetchState);
+}
 function doStop(){  fetch('/stop').then(fetchState); }
 
 function parseLocaleNumber(s){ if(typeof s!=='string') return NaN; s=s.replace(',', '.'); return Number(s); }
@@ -739,10 +764,12 @@ function updateRunInfo(){
     } else if (timerView === 1){
       extra.textContent = 'do końca etapu: ' + formatDuration(remain);
     } else {
-      const finish = new Date(Date.now() + remain*1000);
+      // koniec całego programu (ETA z ESP), bez niej – koniec etapu
+      const prog   = typeof d.eta === 'number';
+      const finish = new Date(Date.now() + (prog ? d.eta : remain)*1000);
       const hh = String(finish.getHours()).padStart(2,'0');
       const mm = String(finish.getMinutes()).padStart(2,'0');
-      extra.textContent = 'koniec etapu ok. ' + hh + ':' + mm;
+      extra.textContent = (prog ? 'koniec programu ok. ' : 'koniec etapu ok. ') + hh + ':' + mm;
     }
     return;
   }
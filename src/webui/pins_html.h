@@ -60,7 +60,7 @@ static const char PINS_HTML[] PROGMEM = R"HTML(
 </div>
 <script>
 // Role logiczne – muszą odpowiadać CFG.pins.*
-const ROLES = ["I2C_SDA","I2C_SCL","SPI_MOSI","SPI_MISO","SPI_SCK","SPI_CS","SSR","LED","BUZZ"];
+const ROLES = ["I2C_SDA","I2C_SCL","SPI_MOSI","SPI_MISO","SPI_SCK","SPI_CS","SPI_CS2","SSR","SSR2","SSR3","LED","BUZZ"];
 
 // Dostępne GPIO (w tym -1 = Brak)
 const GPIOS = [-1,16,5,4,0,2,14,12,13,15,3,1];
@@ -73,7 +73,10 @@ const DEFAULT_PINS = {
   SPI_MISO: 12,  // D6
   SPI_SCK: 14,   // D5
   SPI_CS: 15,    // D8
+  SPI_CS2: -1,   // drugi MAX31855 – termopara przy wyrobie (kaskada)
   SSR: 2,        // D4
+  SSR2: -1,      // kolejne sekcje grzałek – tylko w większych piecach
+  SSR3: -1,
   BUZZ: 16,      // D0
   LED: 0         // D3 (GPIO0) – LED statusowy
 };
@@ -47,7 +47,7 @@ static const char PROFILE_HTML[] PROGMEM = R"HTML(
   </div>
 
   <div class="card">
-    <table id="tbl"><thead><tr><th>#</th><th>Temperatura (°C)</th><th>Czas trwania</th><th></th></tr></thead><tbody></tbody></table>
+    <table id="tbl"><thead><tr><th>#</th><th>Temperatura (°C)</th><th>Rampa ↑ (°C/h)</th><th>Rampa ↓ (°C/h)</th><th>Wytrzymanie</th><th>Pasmo ±°C</th><th>Maks. czekanie (min)</th><th>Stożek</th><th></th></tr></thead><tbody></tbody></table>
     <div class="row" style="margin-top:10px">
       <button class="btn" onclick="addRow()">Dodaj krok</button>
       <button class="btn" onclick="saveProfile()">Zapisz profil tymczasowy</button>
@@ -57,7 +57,14 @@ static const char PROFILE_HTML[] PROGMEM = R"HTML(
       <b>„Zapisz tymczasowy profil”</b> – zapisuje aktualny program jako aktywny (używany przy następnym START).<br>
       <b>„Zapisz jako”</b> u góry – zapisuje program do pamięci nazwanych profili (lista rozwijana).<br>
       Czas podaj jako <b>min</b> lub z sufiksem: <code>h</code>, <code>m</code>, <code>s</code> (np. <code>10m</code>, <code>4h</code>).<br>
-      Maks. 8 kroków. Zakres temperatur: 0–2000&nbsp;°C. Tryb profilowy pokazuje na OLED <code>minęło / zostało</code> dla bieżącego etapu.
+      Rampa w <b>°C/h</b> (↑ przy grzaniu, ↓ przy studzeniu); <code>0</code> = skok zadanej. Wytrzymanie liczy się od końca rampy.<br>
+      Rampa ↓ to <b>studzenie kontrolowane</b> – sterownik dogrzewa, żeby piec nie stygł szybciej; gdy piec sam stygnie wolniej, rampa na niego czeka
+      (<b>maks. czekanie</b> ogranicza też to czekanie).<br>
+      <b>Pasmo ±°C</b> &gt; 0 – wytrzymanie rusza dopiero, gdy piec jest w paśmie wokół celu (gwarantowane wygrzanie);
+      <b>maks. czekanie</b> ogranicza to czekanie (0 = bez limitu).<br>
+      <b>Stożek</b> (Orton, np. <code>06</code>, <code>6</code>) – wytrzymanie kończy się, gdy praca cieplna wypału odpowiada temu stożkowi;
+      czas wytrzymania jest wtedy górną granicą (<code>0</code> = czekaj tylko na stożek). Puste = bez warunku.<br>
+      Maks. 64 segmenty (krok bez rampy = 1, z rampą = 2). Zakres temperatur: 0–2000&nbsp;°C. Tryb profilowy pokazuje na OLED <code>minęło / zostało</code> dla bieżącego etapu (rampa + wytrzymanie).
     </div>
 
   </div>
@@ -73,7 +80,12 @@ function fmtRow(i,step){
   return `<tr>
   <td>${i+1}</td>
   <td><input type="number" step="1" min="0" max="2000" value="${step.targetC||0}" data-k="t"></td>
+  <td><input type="number" step="1" min="0" max="9999" value="${step.r||0}" data-k="r"></td>
+  <td><input type="number" step="1" min="0" max="9999" value="${step.rd||0}" data-k="rd"></td>
   <td><input type="text" value="${step.h||""}" placeholder="np. 10m, 30m, 4h" data-k="h"></td>
+  <td><input type="number" step="1" min="0" max="255" value="${step.b||0}" data-k="b"></td>
+  <td><input type="number" step="1" min="0" max="65535" value="${step.w||0}" data-k="w"></td>
+  <td><input type="text" value="${step.c||""}" placeholder="np. 06, 6" size="4" data-k="c"></td>
   <td><button class="btn" onclick="delRow(${i})">Usuń</button></td>
 </tr>`;
 }
@@ -93,6 +105,11 @@ async function loadActiveProfile(){
   const d=await r.json();
   data = (d.steps||[]).map(s=>({
     targetC: s.targetC||0,
+    r: s.rampCph||0,
+    rd: s.rampDownCph||0,
+    b: s.bandC||0,
+    w: s.maxWaitMin||0,
+    c: s.cone||"",
     h: (s.holdSec? (Math.round(s.holdSec/60))+'m': '0m')
   }));
   render();
@@ -103,18 +120,39 @@ function render(){
   data.forEach((s,i)=>tb.insertAdjacentHTML("beforeend", fmtRow(i,s)));
 }
 
-function addRow(){ if(data.length<8){ data.push({targetC:200,h:"10m"}); render(); } }
+// pula sterownika: 64 segmenty – krok bez rampy = 1, z rampą = 2
+const MAX_SEGS=64;
+// stożki Orton znane sterownikowi (heat_work.cpp)
+const CONES=["010","09","08","07","06","05","04","03","02","01","1","2","3","4","5","6","7","8","9","10"];
+function segCount(){
+  return [...document.querySelectorAll('#tbl tbody tr')].reduce((n,tr)=>{
+    const r=parseFloat(tr.querySelector('input[data-k="r"]').value||"0");
+    const rd=parseFloat(tr.querySelector('input[data-k="rd"]').value||"0");
+    return n + ((r>0||rd>0)?2:1);
+  },0);
+}
+function addRow(){ if(segCount()<MAX_SEGS){ data.push({targetC:200,r:0,rd:0,h:"10m",b:0,w:0,c:""}); render(); } else setMsg("Limit 64 segmentów.", true); }
 function delRow(i){ data.splice(i,1); render(); }
 
 async function saveProfile(){
   const rows=[...document.querySelectorAll('#tbl tbody tr')];
+  if(segCount()>MAX_SEGS){ setMsg("Za długi program (maks. 64 segmenty).", true); return; }
   const steps=[];
   for(let i=0;i<rows.length;i++){
     const t = parseFloat(rows[i].querySelector('input[data-k="t"]').value||"0");
     const h = rows[i].querySelector('input[data-k="h"]').value||"0m";
+    const ru = parseFloat(rows[i].querySelector('input[data-k="r"]').value||"0");
+    const rd = parseFloat(rows[i].querySelector('input[data-k="rd"]').value||"0");
     const sec = toSec(h);
     if(!(isFinite(t) && isFinite(sec) && sec>=0 && t>=0 && t<=2000)) { setMsg("Błędne wartości (0–2000°C, czas >=0).", true); return; }
-    steps.push({targetC: Math.round(t), holdSec: Math.round(sec)});
+    const b = parseFloat(rows[i].querySelector('input[data-k="b"]').value||"0");
+    const w = parseFloat(rows[i].querySelector('input[data-k="w"]').value||"0");
+    const c = (rows[i].querySelector('input[data-k="c"]').value||"").trim();
+    if(!(ru>=0 && ru<=9999 && rd>=0 && rd<=9999)) { setMsg("Błędna rampa (0–9999 °C/h).", true); return; }
+    if(!(b>=0 && b<=255 && w>=0 && w<=65535)) { setMsg("Błędne pasmo (0–255 °C) lub czekanie.", true); return; }
+    if(c && !CONES.includes(c)) { setMsg("Nieznany stożek (010…01, 1…10).", true); return; }
+    steps.push({targetC: Math.round(t), holdSec: Math.round(sec), rampCph: Math.round(ru), rampDownCph: Math.round(rd),
+                bandC: Math.round(b), maxWaitMin: Math.round(w), ...(c ? {cone: c} : {})});
   }
   const r=await fetch('/profile/save',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({steps})});
   if(r.ok){ setMsg("Zapisano aktywny profil. Aktywne od następnego START.", false); await refreshProfiles(); }
@@ -154,13 +192,23 @@ async function saveNamed(){
   if(!name){ setMsgTop("Podaj nazwę profilu.", true); return; }
 
   const rows=[...document.querySelectorAll('#tbl tbody tr')];
+  if(segCount()>MAX_SEGS){ setMsgTop("Za długi program (maks. 64 segmenty).", true); return; }
   const steps=[];
   for(let i=0;i<rows.length;i++){
     const t = parseFloat(rows[i].querySelector('input[data-k="t"]').value||"0");
     const h = rows[i].querySelector('input[data-k="h"]').value||"0m";
+    const ru = parseFloat(rows[i].querySelector('input[data-k="r"]').value||"0");
+    const rd = parseFloat(rows[i].querySelector('input[data-k="rd"]').value||"0");
     const sec = toSec(h);
     if(!(isFinite(t) && isFinite(sec) && sec>=0 && t>=0 && t<=2000)) { setMsgTop("Błędne wartości (0–2000°C, czas >=0).", true); return; }
-    steps.push({targetC: Math.round(t), holdSec: Math.round(sec)});
+    const b = parseFloat(rows[i].querySelector('input[data-k="b"]').value||"0");
+    const w = parseFloat(rows[i].querySelector('input[data-k="w"]').value||"0");
+    const c = (rows[i].querySelector('input[data-k="c"]').value||"").trim();
+    if(!(ru>=0 && ru<=9999 && rd>=0 && rd<=9999)) { setMsgTop("Błędna rampa (0–9999 °C/h).", true); return; }
+    if(!(b>=0 && b<=255 && w>=0 && w<=65535)) { setMsgTop("Błędne pasmo (0–255 °C) lub czekanie.", true); return; }
+    if(c && !CONES.includes(c)) { setMsgTop("Nieznany stożek (010…01, 1…10).", true); return; }
+    steps.push({targetC: Math.round(t), holdSec: Math.round(sec), rampCph: Math.round(ru), rampDownCph: Math.round(rd),
+                bandC: Math.round(b), maxWaitMin: Math.round(w), ...(c ? {cone: c} : {})});
   }
 
   const r = await fetch('/profiles/save?name='+encodeURIComponent(name),{
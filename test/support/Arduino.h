@@ -0,0 +1,31 @@
+/***************************************************************************************
+ * FILE: test/support/Arduino.h
+ * LAST MODIFIED: 2026-10-20 04:00 (Europe/Warsaw)
+ * PURPOSE: Minimalne Arduino.h dla testów natywnych (env:native) – moduły bez sprzętu
+ ***************************************************************************************/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Tylko to, czego używają moduły z build_src_filter env:native (PID, autotune, estymator,
+// predyktor, modulator SSR, nadzór, watchdog). Zegar nie płynie sam – ustawia go test.
+#define IRAM_ATTR
+#define PROGMEM
+
+// piny NodeMCU (domyślne w config.h)
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+#define LED_BUILTIN 2
+
+inline uint32_t FAKE_MILLIS = 0;
+inline unsigned long millis() { return FAKE_MILLIS; }
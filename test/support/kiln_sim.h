@@ -0,0 +1,55 @@
+/***************************************************************************************
+ * FILE: test/support/kiln_sim.h
+ * LAST MODIFIED: 2026-10-20 04:00 (Europe/Warsaw)
+ * PURPOSE: Obiekt do testów natywnych – piec FOPDT z opóźnieniem + pomiar MAX31855
+ ***************************************************************************************/
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+// tau·dT/dt + (T − Tamb) = K·u(t − theta), u w % (0..100), krok dt stały.
+// Euler w przód – przy dt ≪ tau wystarcza, a ten sam obiekt widzą obie strony porównania.
+struct KilnPlant {
+  double K, tauSec, ambC, dtSec, T;
+  std::vector<double> u;   // bufor opóźnienia wejścia
+  size_t head = 0;
+
+  KilnPlant(double k, double tau, double thetaSec, double amb, double dt)
+    : K(k), tauSec(tau), ambC(amb), dtSec(dt), T(amb),
+      u((size_t)lround(thetaSec / dt) + 1, 0.0) {}
+
+  // stan ustalony dla wypełnienia uPct (historia wejścia też)
+  void settle(double uPct) {
+    for (double& v : u) v = uPct;
+    T = ambC + K * uPct;
+  }
+
+  double step(double uPct) {
+    u[head] = uPct;
+    head = (head + 1) % u.size();
+    const double ud = u[head];   // wejście sprzed theta
+    T += dtSec / tauSec * (K * ud - (T - ambC));
+    return T;
+  }
+};
+
+// szum deterministyczny (LCG) – testy powtarzalne bez <random>
+struct TestNoise {
+  uint32_t s;
+  explicit TestNoise(uint32_t seed) : s(seed) {}
+  double uniform() {   // −0.5 .. 0.5
+    s = s * 1664525u + 1013904223u;
+    return (s >> 8) / 16777216.0 - 0.5;
+  }
+  double gauss(double sigma) {   // suma 12 jednostajnych ≈ N(0, 1)
+    double a = 0;
+    for (int i = 0; i < 12; i++) a += uniform();
+    return a * sigma;
+  }
+};
+
+// ramka MAX31855: termopara z szumem, kwant 0.25 °C
+inline double max31855Read(double tC, TestNoise& n, double sigma) {
+  return floor((tC + n.gauss(sigma)) * 4.0 + 0.5) / 4.0;
+}
@@ -0,0 +1,107 @@
+/***************************************************************************************
+ * FILE: test/test_autotune/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 04:00 (Europe/Warsaw)
+ * PURPOSE: Autotune przekaźnikowy – zbieżność na kilku obiektach FOPDT, przypadki błędów
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include "autotune.h"
+#include "kiln_sim.h"
+
+struct Plant { double K, tau, theta, sp; };
+
+// punkt krytyczny FOPDT: atan(ω·tau) + ω·theta = π → Pu = 2π/ω, Ku = √(1 + (ω·tau)²) / K
+static void fopdtCritical(const Plant& p, double& ku, double& pu) {
+  double lo = 1e-7, hi = M_PI / p.theta;
+  for (int i = 0; i < 200; i++) {
+    const double w = 0.5 * (lo + hi);
+    if (atan(w * p.tau) + w * p.theta > M_PI) hi = w; else lo = w;
+  }
+  const double w = 0.5 * (lo + hi);
+  ku = sqrt(1 + w * w * p.tau * p.tau) / p.K;
+  pu = 2 * M_PI / w;
+}
+
+// eksperyment jak w controlLoop(): ramka co 1 s, szum termopary, bias z modelu
+static const RelayAutotune& runRelay(RelayAutotune& at, const Plant& p, bool biasFromModel,
+                                     uint32_t& tookMs) {
+  KilnPlant k(p.K, p.tau, p.theta, 20, 1.0);
+  TestNoise n(7);
+  const q16_t bias = biasFromModel ? q16FromDouble((p.sp - 20) / p.K) : 50 * Q16_ONE;
+  uint32_t ms = 0;
+  at.start(ms, q16FromDouble(p.sp), q16FromDouble(1.0), bias);
+  q16_t duty = 0;
+  while (at.update(ms, q16FromDouble(max31855Read(k.T, n, 0.25)), duty) && ms < 24UL * 3600000UL) {
+    k.step(q16ToDouble(duty));
+    ms += 1000;
+  }
+  tookMs = ms;
+  return at;
+}
+
+static const Plant PLANTS[] = {
+  { 13, 3600,  60,  600 },
+  { 12, 2400,  30,  900 },
+  { 14, 5400, 120, 1000 },
+  { 10, 1800,  20,  300 },
+  { 13, 3600, 240,  700 },
+};
+
+void setUp() {}
+void tearDown() {}
+
+// funkcja opisująca zaniża Ku (przebieg nie jest sinusem) – okres trafia lepiej
+static void test_converges_on_fopdt_plants() {
+  for (const Plant& p : PLANTS) {
+    for (int b = 0; b < 2; b++) {
+      RelayAutotune at;
+      uint32_t took;
+      runRelay(at, p, b == 1, took);
+      char msg[96];
+      snprintf(msg, sizeof(msg), "K=%g tau=%g theta=%g sp=%g bias=%s: %s",
+               p.K, p.tau, p.theta, p.sp, b ? "model" : "50%", at.error());
+      TEST_ASSERT_TRUE_MESSAGE(at.state() == AT_DONE, msg);
+      TEST_ASSERT_TRUE_MESSAGE(took < 6UL * 3600000UL, msg);
+
+      double ku, pu;
+      fopdtCritical(p, ku, pu);
+      const AutotuneResult& r = at.result();
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.35 * pu, pu, r.PuSec, msg);
+      TEST_ASSERT_TRUE_MESSAGE(r.Ku > 0.5 * ku && r.Ku < 1.1 * ku, msg);
+
+      // Ziegler–Nichols (klasyczny PID)
+      TEST_ASSERT_FLOAT_WITHIN(1e-9, 0.6 * r.Ku, r.Kp);
+      TEST_ASSERT_FLOAT_WITHIN(1e-9, r.Kp / (r.PuSec / 2), r.Ki);
+      TEST_ASSERT_FLOAT_WITHIN(1e-9, r.Kp * r.PuSec / 8, r.Kd);
+    }
+  }
+}
+
+// zadana poza zasięgiem grzałek – półcykl grzania nie kończy się w 3 h
+static void test_unreachable_setpoint_times_out() {
+  RelayAutotune at;
+  uint32_t took;
+  runRelay(at, Plant{ 5, 3600, 60, 900 }, false, took);
+  TEST_ASSERT_EQUAL_INT(AT_FAILED, at.state());
+  TEST_ASSERT_EQUAL_STRING("timeout", at.error());
+}
+
+static void test_cancel() {
+  RelayAutotune at;
+  at.start(0, q16FromDouble(600), Q16_ONE);
+  q16_t duty;
+  TEST_ASSERT_TRUE(at.update(1000, q16FromDouble(20), duty));
+  TEST_ASSERT_TRUE(duty > 0);   // poniżej zadanej – grzeje
+  at.cancel();
+  TEST_ASSERT_FALSE(at.update(2000, q16FromDouble(20), duty));
+  TEST_ASSERT_EQUAL_INT(0, duty);
+  TEST_ASSERT_EQUAL_STRING("cancelled", at.error());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_converges_on_fopdt_plants);
+  RUN_TEST(test_unreachable_setpoint_times_out);
+  RUN_TEST(test_cancel);
+  return UNITY_END();
+}
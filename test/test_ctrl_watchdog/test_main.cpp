@@ -0,0 +1,112 @@
+/***************************************************************************************
+ * FILE: test/test_ctrl_watchdog/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 04:50 (Europe/Warsaw)
+ * PURPOSE: Watchdog sterowania – ticki w terminie i ponad termin, zagłodzenie, powrót, restart
+ ***************************************************************************************/
+#include <unity.h>
+#include "ctrl_watchdog.h"
+
+// przebieg jak na ESP: przerwanie co ISR_PERIOD_MS, tick sterowania trwa tickMs (co drugi
+// 10 ms, gdy alternate), po nim gapMs przerwy w loop(); chwila pierwszego zagłodzenia, 0 = brak
+static uint32_t runTicks(CtrlWatchdog& wd, uint32_t fromMs, uint32_t toMs,
+                         uint32_t tickMs, uint32_t gapMs, bool alternate = false) {
+  uint32_t nextIsr   = fromMs + CtrlWatchdog::ISR_PERIOD_MS;
+  uint32_t tickStart = fromMs;
+  uint32_t len       = tickMs;
+  for (uint32_t t = fromMs; t < toMs; t++) {
+    if (t == nextIsr) {
+      nextIsr += CtrlWatchdog::ISR_PERIOD_MS;
+      if (wd.isrTick()) return t;
+    }
+    if (t == tickStart + len) {
+      wd.takeStarved();   // ctrlWatchdogRecover() na początku ticku – licznika nie rusza
+      wd.feed(tickStart, t);
+      tickStart = t + gapMs;
+      len = (alternate && len == tickMs) ? 10 : tickMs;
+    }
+  }
+  return 0;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_timely_ticks_never_starve() {
+  CtrlWatchdog wd;
+  wd.begin(0);
+  TEST_ASSERT_EQUAL_UINT32(0, runTicks(wd, 0, 600000, 40, 5));
+  TEST_ASSERT_EQUAL_UINT32(0, runTicks(wd, 600000, 1200000, 10, 300));
+  TEST_ASSERT_FALSE(wd.takeStarved());
+}
+
+// seria ticków po 900 ms – każdy się kończy, ale żaden w terminie: grzałki OFF po ~1 s
+static void test_repeated_overruns_starve() {
+  CtrlWatchdog wd;
+  wd.begin(0);
+  const uint32_t at = runTicks(wd, 0, 60000, 900, 5);
+  TEST_ASSERT_TRUE(at > 0);
+  TEST_ASSERT_TRUE(at <= (CtrlWatchdog::STARVE_TICKS + 1) * CtrlWatchdog::ISR_PERIOD_MS);
+  TEST_ASSERT_TRUE(wd.takeStarved());
+  TEST_ASSERT_EQUAL_UINT32(0, wd.fedMs());
+
+  // dopóki ticki są za długie, każde przerwanie gasi grzałki od nowa
+  for (int i = 0; i < 20; i++) TEST_ASSERT_TRUE(wd.isrTick());
+  TEST_ASSERT_FALSE(wd.feed(5000, 5000 + CtrlWatchdog::DEADLINE_MS + 1));
+  TEST_ASSERT_TRUE(wd.isrTick());
+}
+
+// krótkie przekroczenia przeplatane tickami w terminie nie gaszą grzałek
+static void test_occasional_overrun_tolerated() {
+  CtrlWatchdog wd;
+  wd.begin(0);
+  TEST_ASSERT_EQUAL_UINT32(0, runTicks(wd, 0, 600000, 400, 5, true));
+  // te same ticki bez przerywników w terminie – przekroczenia się sumują
+  wd.begin(0);
+  TEST_ASSERT_TRUE(runTicks(wd, 0, 60000, 400, 5) > 0);
+}
+
+// pętla stoi 3 s, potem wraca w termin: jedno zagłodzenie, pierwszy udany tick je kończy
+static void test_recovery_after_stall() {
+  CtrlWatchdog wd;
+  wd.begin(0);
+  uint32_t t = 100;
+  for (uint8_t i = 0; i < CtrlWatchdog::STARVE_TICKS; i++, t += 100) TEST_ASSERT_FALSE(wd.isrTick());
+  for (; t <= 3000; t += 100) TEST_ASSERT_TRUE(wd.isrTick());
+  TEST_ASSERT_EQUAL_UINT32(CtrlWatchdog::STARVE_TICKS * CtrlWatchdog::ISR_PERIOD_MS, wd.offMs());
+
+  TEST_ASSERT_TRUE(wd.takeStarved());
+  TEST_ASSERT_FALSE(wd.takeStarved());
+  TEST_ASSERT_TRUE(wd.feed(3010, 3020));
+  TEST_ASSERT_EQUAL_UINT32(3020, wd.fedMs());
+  TEST_ASSERT_FALSE(wd.isrTick());
+  TEST_ASSERT_FALSE(wd.takeStarved());
+}
+
+// restart dopiero po RESTART_MISSES ticków ponad termin z rzędu – tick w terminie zeruje serię
+static void test_restart_after_consecutive_misses() {
+  CtrlWatchdog wd;
+  wd.begin(0);
+  uint32_t t = 0;
+  for (uint8_t i = 0; i + 1 < CtrlWatchdog::RESTART_MISSES; i++, t += 100) {
+    TEST_ASSERT_FALSE(wd.feed(t, t + 90));
+    TEST_ASSERT_FALSE(wd.restartDue());
+  }
+  TEST_ASSERT_TRUE(wd.feed(t, t + 10));
+  t += 100;
+  for (uint8_t i = 0; i + 1 < CtrlWatchdog::RESTART_MISSES; i++, t += 100) TEST_ASSERT_FALSE(wd.feed(t, t + 90));
+  TEST_ASSERT_FALSE(wd.restartDue());
+  TEST_ASSERT_FALSE(wd.feed(t, t + 90));
+  TEST_ASSERT_TRUE(wd.restartDue());
+  wd.begin(t + 100);
+  TEST_ASSERT_FALSE(wd.restartDue());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_timely_ticks_never_starve);
+  RUN_TEST(test_repeated_overruns_starve);
+  RUN_TEST(test_occasional_overrun_tolerated);
+  RUN_TEST(test_recovery_after_stall);
+  RUN_TEST(test_restart_after_consecutive_misses);
+  return UNITY_END();
+}
@@ -0,0 +1,144 @@
+/***************************************************************************************
+ * FILE: test/test_heat_work/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 05:50 (Europe/Warsaw)
+ * PURPOSE: Praca cieplna – dojrzewanie stożków przy różnych rampach vs tabela Orton,
+ *          wytrzymanie, restore(), nazwy stożków
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include "heat_work.h"
+
+static const uint32_t FRAME_MS = 250;
+
+// rampa rateCph od 600 °C, ramka co 250 ms; temperatura, przy której dojrzał każdy stożek
+static void rampCones(double rateCph, double out[CONE_COUNT]) {
+  HeatWork h;
+  h.reset();
+  for (uint8_t i = 0; i < CONE_COUNT; i++) out[i] = NAN;
+  double T = 600;
+  int8_t last = -1;
+  while (T < 1400 && last + 1 < CONE_COUNT) {
+    T += rateCph * FRAME_MS / 3600000.0;
+    h.add((int32_t)lround(T * 1000), FRAME_MS);
+    while (last < h.cone()) out[++last] = T;
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// 60 °C/h – kolumna kalibracji: stożek dojrzewa przy temperaturze z tabeli, Teq = T
+static void test_ramp60_matches_table() {
+  double at[CONE_COUNT];
+  rampCones(60, at);
+  for (uint8_t i = 0; i < CONE_COUNT; i++) {
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(1.0, coneTempMilli(i) / 1000.0, at[i], coneName(i));
+  }
+
+  HeatWork h;
+  h.reset();
+  for (double T = 600; T < 1250; T += 60.0 * FRAME_MS / 3600000.0) {
+    h.add((int32_t)lround(T * 1000), FRAME_MS);
+    if (T > 800) TEST_ASSERT_FLOAT_WITHIN(1.0, T, h.teqMilli() / 1000.0);
+  }
+}
+
+// 150 °C/h – kolumna Orton (duże stożki) dla kilku stożków; 15 °C/h – wszystkie niżej niż 60
+static void test_other_ramps_vs_orton() {
+  struct Ref { const char* cone; double c150; };
+  static const Ref ORTON150[] = { { "06", 1013 }, { "04", 1083 }, { "6", 1243 }, { "10", 1305 } };
+  double at15[CONE_COUNT], at150[CONE_COUNT];
+  rampCones(15, at15);
+  rampCones(150, at150);
+
+  char msg[96];
+  for (const Ref& r : ORTON150) {
+    const int8_t i = coneFromName(r.cone);
+    TEST_ASSERT_TRUE(i >= 0);
+    snprintf(msg, sizeof(msg), "cone %s @150 C/h: %.0f C (Orton %.0f)", r.cone, at150[i], r.c150);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(6.0, r.c150, at150[i], msg);
+  }
+  for (uint8_t i = 0; i < CONE_COUNT; i++) {
+    const double c60 = coneTempMilli(i) / 1000.0;
+    TEST_ASSERT_TRUE_MESSAGE(at150[i] - c60 >= 12 && at150[i] - c60 <= 23, coneName(i));
+    TEST_ASSERT_TRUE_MESSAGE(c60 - at15[i] >= 12 && c60 - at15[i] <= 35, coneName(i));
+  }
+}
+
+// wytrzymanie: 150 °C/h do 1210 °C + 20 min – cone 6 (1222 °C przy 60 °C/h) dojrzewa w holdzie
+static void test_hold_matures_cone() {
+  const int8_t c6 = coneFromName("6");
+  HeatWork h;
+  h.reset();
+  double T = 600;
+  while (T < 1210) {
+    T += 150.0 * FRAME_MS / 3600000.0;
+    h.add((int32_t)lround(T * 1000), FRAME_MS);
+  }
+  TEST_ASSERT_FALSE(h.reached(c6));
+  uint32_t holdMs = 0;
+  while (!h.reached(c6) && holdMs < 3600000UL) {
+    h.add(1210000, FRAME_MS);
+    holdMs += FRAME_MS;
+  }
+  TEST_ASSERT_TRUE(h.reached(c6));
+  TEST_ASSERT_TRUE(holdMs > 5UL * 60000UL && holdMs < 40UL * 60000UL);
+
+  // poniżej 700 °C praca pomijalna; praca nie maleje przy stygnięciu
+  const int32_t teq = h.teqMilli();
+  h.add(650000, 3600000UL);
+  h.add(900000, 60000UL);
+  TEST_ASSERT_EQUAL_INT(teq, h.teqMilli());
+}
+
+// checkpoint trzyma Teq – po restore() ten sam Teq i stożek, dalej liczy jak bez przerwy
+static void test_restore_round_trip() {
+  HeatWork a, b;
+  a.reset();
+  for (double T = 600; T < 1180; T += 100.0 * FRAME_MS / 3600000.0) a.add((int32_t)lround(T * 1000), FRAME_MS);
+  b.restore(a.teqMilli());
+  TEST_ASSERT_INT32_WITHIN(5, a.teqMilli(), b.teqMilli());
+  TEST_ASSERT_EQUAL_INT(a.cone(), b.cone());
+  for (int i = 0; i < 4 * 600; i++) {
+    a.add(1190000, FRAME_MS);
+    b.add(1190000, FRAME_MS);
+  }
+  TEST_ASSERT_INT32_WITHIN(50, a.teqMilli(), b.teqMilli());
+
+  b.restore(0);
+  TEST_ASSERT_EQUAL_INT(0, b.teqMilli());
+  TEST_ASSERT_EQUAL_INT(-1, b.cone());
+}
+
+// nazwy: „06” i „6” to różne stożki (zero wiodące = stożki niskie), bez tolerancji formatu
+static void test_cone_names() {
+  TEST_ASSERT_EQUAL_INT(0,  coneFromName("010"));
+  TEST_ASSERT_EQUAL_INT(4,  coneFromName("06"));
+  TEST_ASSERT_EQUAL_INT(9,  coneFromName("01"));
+  TEST_ASSERT_EQUAL_INT(10, coneFromName("1"));
+  TEST_ASSERT_EQUAL_INT(15, coneFromName("6"));
+  TEST_ASSERT_EQUAL_INT(19, coneFromName("10"));
+  TEST_ASSERT_EQUAL_INT(-1, coneFromName(nullptr));
+  TEST_ASSERT_EQUAL_INT(-1, coneFromName(""));
+  TEST_ASSERT_EQUAL_INT(-1, coneFromName("011"));
+  TEST_ASSERT_EQUAL_INT(-1, coneFromName("11"));
+  TEST_ASSERT_EQUAL_INT(-1, coneFromName("6 "));
+  TEST_ASSERT_EQUAL_INT(-1, coneFromName("cone 6"));
+  for (uint8_t i = 0; i < CONE_COUNT; i++) {
+    TEST_ASSERT_EQUAL_INT(i, coneFromName(coneName(i)));
+    if (i) TEST_ASSERT_TRUE(coneTempMilli(i) > coneTempMilli(i - 1));
+  }
+  TEST_ASSERT_EQUAL_STRING("", coneName(CONE_COUNT));
+  TEST_ASSERT_EQUAL_INT(0, coneTempMilli(CONE_COUNT));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_ramp60_matches_table);
+  RUN_TEST(test_other_ramps_vs_orton);
+  RUN_TEST(test_hold_matures_cone);
+  RUN_TEST(test_restore_round_trip);
+  RUN_TEST(test_cone_names);
+  return UNITY_END();
+}
@@ -0,0 +1,137 @@
+/***************************************************************************************
+ * FILE: test/test_loop_monitor/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 06:00 (Europe/Warsaw)
+ * PURPOSE: Nadzór pętli – oscylacja trwała / gasnąca / drganie, SLUGGISH, pętla z PID
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include "loop_monitor.h"
+#include "pid_fixed.h"
+#include "kiln_sim.h"
+
+static const uint32_t STEP_MS = 1000;
+
+// uchyb e(t) = amp·decay^(t/half)·sin(2πt/period) + szum, krok co 1 s; pierwszy werdykt
+// (LOOP_OK = brak) i chwila werdyktu
+struct Verdict { LoopHealth h; uint32_t atMs; };
+
+static Verdict runSine(LoopMonitor& lm, double amp, double periodSec, double decayPerHalf,
+                       uint32_t durMs, double noise = 0.1, bool saturated = false) {
+  TestNoise n(21);
+  lm.reset(0);
+  for (uint32_t t = STEP_MS; t <= durMs; t += STEP_MS) {
+    const double halves = t / 1000.0 / (periodSec / 2);
+    const double e = amp * pow(decayPerHalf, halves) * sin(2 * M_PI * t / 1000.0 / periodSec) +
+                     n.gauss(noise);
+    if (lm.update(t, q16FromDouble(e), true, saturated)) return { lm.health(), t };
+  }
+  return { LOOP_OK, 0 };
+}
+
+void setUp() {}
+void tearDown() {}
+
+// cykl graniczny ±5 °C, okres 20 min: werdykt po 4 półokresach, okres i amplituda ze statystyk
+static void test_sustained_oscillation() {
+  LoopMonitor lm;
+  const Verdict v = runSine(lm, 5, 1200, 1.0, 4UL * 3600000UL);
+  TEST_ASSERT_EQUAL_STRING("oscillating", loopHealthName(v.h));
+  TEST_ASSERT_TRUE(v.atMs <= 3UL * 1200000UL);
+  TEST_ASSERT_INT32_WITHIN(60000, 1200000, lm.stats().periodMs);
+  TEST_ASSERT_FLOAT_WITHIN(0.5, 5.0, q16ToDouble(lm.stats().ampQ));
+}
+
+// oscylacje, które nie przeszkadzają: gasnąca (każdy półokres ×0.5), za mała (±1.5 °C),
+// drganie szybsze niż półokres 30 s (przekaźnik, szum)
+static void test_no_false_oscillation() {
+  LoopMonitor lm;
+  TEST_ASSERT_EQUAL_STRING("ok", loopHealthName(runSine(lm, 20, 1200, 0.5, 4UL * 3600000UL).h));
+  TEST_ASSERT_EQUAL_STRING("ok", loopHealthName(runSine(lm, 1.5, 1200, 1.0, 4UL * 3600000UL).h));
+  TEST_ASSERT_EQUAL_STRING("ok", loopHealthName(runSine(lm, 5, 40, 1.0, 4UL * 3600000UL).h));
+  TEST_ASSERT_EQUAL_STRING("ok", loopHealthName(lm.health()));
+}
+
+// 5 °C poniżej zadanej bez przejścia przez zero: SLUGGISH po 30 min; w nasyceniu (brak mocy)
+// i przy małym uchybie – bez werdyktu
+static void test_sluggish() {
+  LoopMonitor lm;
+  lm.reset(0);
+  uint32_t at = 0;
+  for (uint32_t t = STEP_MS; t <= 2UL * 3600000UL && !at; t += STEP_MS) {
+    if (lm.update(t, q16FromDouble(5.0 - t / 3600000.0), true, false)) at = t;
+  }
+  TEST_ASSERT_EQUAL_STRING("sluggish", loopHealthName(lm.health()));
+  TEST_ASSERT_INT32_WITHIN(STEP_MS, 30UL * 60000UL, at);
+
+  LoopMonitor sat;
+  sat.reset(0);
+  for (uint32_t t = STEP_MS; t <= 2UL * 3600000UL; t += STEP_MS) {
+    TEST_ASSERT_FALSE(sat.update(t, q16FromDouble(5.0), true, true));
+  }
+  LoopMonitor small;
+  small.reset(0);
+  for (uint32_t t = STEP_MS; t <= 2UL * 3600000UL; t += STEP_MS) {
+    TEST_ASSERT_FALSE(small.update(t, q16FromDouble(2.0), true, false));
+  }
+}
+
+// rampa / zmiana zadanej (steady = false) przerywa zbieranie półokresów
+static void test_not_steady_resets() {
+  LoopMonitor lm;
+  lm.reset(0);
+  bool verdict = false;
+  for (uint32_t t = STEP_MS; t <= 6UL * 3600000UL; t += STEP_MS) {
+    const bool steady = (t / 1800000UL) % 2 == 0;   // co 30 min rampa
+    verdict |= lm.update(t, q16FromDouble(5 * sin(2 * M_PI * t / 1200000.0)), steady, false);
+  }
+  TEST_ASSERT_FALSE(verdict);
+}
+
+// pętla z PID na obiekcie FOPDT: przesterowane Kp → oscylacja wykryta; nastawy SIMC – cisza
+static LoopHealth closedLoop(double kp, double ti, uint32_t& atMs) {
+  const double K = 12, TAU = 1800, THETA = 240, SP = 800;
+  KilnPlant k(K, TAU, THETA, 20, 1.0);
+  k.settle((SP - 20) / K);
+  TestNoise n(8);
+  FixedPID pid;
+  pid.setSampleTime(STEP_MS);
+  pid.setTunings(kp, kp / ti, 0);
+  pid.setOutputLimits(0, 100 * Q16_ONE);
+  const q16_t u0 = q16FromDouble((SP - 20) / K);
+  pid.initialize(q16FromDouble(SP), q16FromDouble(SP - 5), u0);   // start 5 °C pod zadaną
+  LoopMonitor lm;
+  lm.reset(0);
+  q16_t u = u0;
+  double meas = k.T;
+  for (uint32_t t = STEP_MS; t <= 8UL * 3600000UL; t += STEP_MS) {
+    const q16_t in = q16FromDouble(meas);
+    pid.compute(t, in, q16FromDouble(SP), u);
+    const bool sat = u <= 0 || u >= 100 * Q16_ONE;
+    if (lm.update(t, q16FromDouble(SP) - in, true, sat)) { atMs = t; return lm.health(); }
+    meas = max31855Read(k.step(q16ToDouble(u)), n, 0.1);
+  }
+  atMs = 0;
+  return LOOP_OK;
+}
+
+static void test_closed_loop_verdicts() {
+  uint32_t at = 0;
+  // Kc = tau / (K·(tauc + theta)), Ti = min(tau, 4·(tauc + theta)), tauc = theta
+  const double kcSimc = 1800.0 / (12 * 480), tiSimc = 1800;
+  TEST_ASSERT_EQUAL_STRING("ok", loopHealthName(closedLoop(kcSimc, tiSimc, at)));
+  const LoopHealth h = closedLoop(6 * kcSimc, 600, at);
+  char msg[80];
+  snprintf(msg, sizeof(msg), "Kp x6: %s after %lu min", loopHealthName(h), (unsigned long)(at / 60000UL));
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL_STRING("oscillating", loopHealthName(h));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sustained_oscillation);
+  RUN_TEST(test_no_false_oscillation);
+  RUN_TEST(test_sluggish);
+  RUN_TEST(test_not_steady_resets);
+  RUN_TEST(test_closed_loop_verdicts);
+  return UNITY_END();
+}
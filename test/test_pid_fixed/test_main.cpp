@@ -0,0 +1,218 @@
+/***************************************************************************************
+ * FILE: test/test_pid_fixed/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 05:20 (Europe/Warsaw)
+ * PURPOSE: FixedPID (Q16.16) kontra PID_v1 na double – zgodność, filtr D w harmonogramie,
+ *          koszt compute()
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "pid_fixed.h"
+#include "kiln_sim.h"
+
+// PID_v1 (br3ttb) w double – regulator sprzed USE_FIXEDPID: Ki·Ts, Kd/Ts, D od pomiaru,
+// całka obcinana do limitów wyjścia
+struct DoublePID {
+  double kp, ki, kd, outMin = 0, outMax = 100;
+  double sum = 0, lastIn = 0;
+  uint32_t sampleMs = 100, lastMs = 0;
+  bool started = false;
+
+  DoublePID(double Kp, double Ki, double Kd) {
+    const double ts = sampleMs / 1000.0;
+    kp = Kp; ki = Ki * ts; kd = Kd / ts;
+  }
+
+  bool compute(uint32_t now, double in, double sp, double& out) {
+    if (started && now - lastMs < sampleMs) return false;
+    started = true;
+    const double e = sp - in;
+    sum += ki * e;
+    if (sum > outMax) sum = outMax;
+    if (sum < outMin) sum = outMin;
+    double v = kp * e + sum - kd * (in - lastIn);
+    out = v > outMax ? outMax : (v < outMin ? outMin : v);
+    lastIn = in;
+    lastMs = now;
+    return true;
+  }
+};
+
+static const double KP = 20, KI = 0.8, KD = 50;   // domyślne CFG.pid
+
+void setUp() {}
+void tearDown() {}
+
+// bez nasycenia: te same próbki, te same chwile przeliczenia, wyjście co do ułamka %
+static void test_open_loop_matches_double() {
+  DoublePID ref(KP, KI, KD);
+  ref.outMin = -3000; ref.outMax = 3000;
+  FixedPID fx;
+  fx.setTunings(KP, KI, KD);
+  fx.setOutputLimits(-3000 * Q16_ONE, 3000 * Q16_ONE);
+
+  TestNoise n(11);
+  double in = 500, maxErr = 0;
+  uint32_t computes = 0;
+  for (uint32_t ms = 0; ms < 2UL * 3600000UL; ms += 50) {
+    const double sp = 500 + 20 * sin(ms / 600000.0);
+    if (ms % 250 == 0) in = max31855Read(sp + 3 * sin(ms / 97000.0), n, 0.15);
+    double o1 = 0;
+    q16_t  o2 = 0;
+    const bool c1 = ref.compute(ms, in, sp, o1);
+    const bool c2 = fx.compute(ms, q16FromDouble(in), q16FromDouble(sp), o2);
+    TEST_ASSERT_TRUE_MESSAGE(c1 == c2, "compute() timing differs from PID_v1");
+    if (!c1) continue;
+    computes++;
+    const double e = fabs(o1 - q16ToDouble(o2));
+    if (e > maxErr) maxErr = e;
+  }
+  TEST_ASSERT_EQUAL_INT(2 * 36000, computes);
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 0.0, maxErr);
+}
+
+// zamknięta pętla z nasyceniem 0..100 %: różni się tylko anti-windup (całkowanie warunkowe
+// zamiast samego obcięcia całki), więc po skoku zadanej – nie większe przeregulowanie,
+// a w ostatniej godzinie każdego wytrzymania ta sama średnia temperatura co z double.
+// Domyślne nastawy przy szumie 0.25 °C cyklicznie nasycają D – stąd ±2 °C od zadanej
+static void test_closed_loop_tracks_double() {
+  DoublePID ref(KP, KI, KD);
+  FixedPID fx;
+  fx.setTunings(KP, KI, KD);
+  fx.setOutputLimits(0, 100 * Q16_ONE);
+
+  KilnPlant p1(12, 1800, 20, 20, 0.05), p2(12, 1800, 20, 20, 0.05);
+  TestNoise n1(3), n2(3);
+  const double sps[] = { 200, 600, 900, 1050 };
+  double o1 = 0, o2 = 0, m1 = 20, m2 = 20;
+  double over1 = 0, over2 = 0, avg1 = 0, avg2 = 0;
+  uint32_t avgN = 0;
+  for (uint32_t ms = 0; ms < 16UL * 3600000UL; ms += 50) {
+    const uint32_t seg = ms / (4UL * 3600000UL);
+    const uint32_t in  = ms % (4UL * 3600000UL);
+    const double   sp  = sps[seg];
+    if (ms % 250 == 0) {
+      m1 = max31855Read(p1.T, n1, 0.1);
+      m2 = max31855Read(p2.T, n2, 0.1);
+    }
+    ref.compute(ms, m1, sp, o1);
+    q16_t q;
+    if (fx.compute(ms, q16FromMilli((int32_t)lround(m2 * 1000)), q16FromDouble(sp), q)) o2 = q16ToDouble(q);
+    p1.step(o1);
+    p2.step(o2);
+    if (in < 2UL * 3600000UL) {   // przejście na nową zadaną
+      if (p1.T - sp > over1) over1 = p1.T - sp;
+      if (p2.T - sp > over2) over2 = p2.T - sp;
+    }
+    if (in >= 3UL * 3600000UL) {  // ostatnia godzina wytrzymania – średnia
+      avg1 += p1.T;
+      avg2 += p2.T;
+      avgN++;
+    }
+    if (in + 50 == 4UL * 3600000UL) {
+      char msg[64];
+      snprintf(msg, sizeof(msg), "segment %u: %.2f vs %.2f C", (unsigned)seg, avg1 / avgN, avg2 / avgN);
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.5, avg1 / avgN, avg2 / avgN, msg);
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(2.0, sp, avg2 / avgN, msg);
+      avg1 = avg2 = 0;
+      avgN = 0;
+    }
+  }
+  TEST_ASSERT_TRUE(over2 <= over1 + 0.5);
+}
+
+// harmonogram nastaw (setScaledGains) z filtrem D: po zmianie Kd to samo wyjście co
+// regulator ustawiony setTunings() na te nastawy – alpha liczona od nowego Td, nie od CFG
+static void test_scheduled_kd_updates_d_filter() {
+  const double kd2 = 200;
+  FixedPID ref, sch;
+  ref.setShaping(1.0, 8.0, 0.0);
+  sch.setShaping(1.0, 8.0, 0.0);
+  ref.setTunings(KP, KI, kd2);
+  sch.setTunings(KP, KI, KD);
+  ref.setOutputLimits(-3000 * Q16_ONE, 3000 * Q16_ONE);
+  sch.setOutputLimits(-3000 * Q16_ONE, 3000 * Q16_ONE);
+
+  q16_t qKp, qKi, qKd;
+  sch.scaleGains(KP, KI, kd2, qKp, qKi, qKd);
+  sch.setScaledGains(qKp, qKi, qKd);
+
+  TestNoise n(4);
+  int32_t maxDiff = 0;
+  for (uint32_t ms = 0; ms < 600000; ms += 100) {
+    const q16_t in = q16FromDouble(max31855Read(500 + 5 * sin(ms / 30000.0), n, 0.15));
+    q16_t o1 = 0, o2 = 0;
+    ref.compute(ms, in, q16FromDouble(505), o1);
+    sch.compute(ms, in, q16FromDouble(505), o2);
+    const int32_t d = o1 > o2 ? o1 - o2 : o2 - o1;
+    if (d > maxDiff) maxDiff = d;
+  }
+  TEST_ASSERT_TRUE(maxDiff <= 2);   // LSB: alpha z Q16.16 zamiast z double
+
+  // zmiana tylko Kd przy tym samym Kp – alpha nadąża także w drugą stronę
+  sch.scaleGains(KP, KI, KD, qKp, qKi, qKd);
+  sch.setScaledGains(qKp, qKi, qKd);
+  ref.setTunings(KP, KI, KD);
+  ref.initialize(q16FromDouble(500), q16FromDouble(505), 0);
+  sch.initialize(q16FromDouble(500), q16FromDouble(505), 0);
+  for (uint32_t ms = 600000; ms < 700000; ms += 100) {
+    const q16_t in = q16FromDouble(max31855Read(500, n, 0.15));
+    q16_t o1 = 0, o2 = 0;
+    ref.compute(ms, in, q16FromDouble(505), o1);
+    sch.compute(ms, in, q16FromDouble(505), o2);
+    TEST_ASSERT_INT32_WITHIN(2, o1, o2);
+  }
+}
+
+// skalowanie do Q16.16 i z powrotem: m°C z linearyzacji termopary, wyjście w %
+static void test_q16_conversions() {
+  TEST_ASSERT_EQUAL_INT(Q16_ONE, q16FromDouble(1.0));
+  TEST_ASSERT_EQUAL_INT(-Q16_ONE / 2, q16FromDouble(-0.5));
+  for (int32_t mC = -20000; mC <= 1372000; mC += 7919) {
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, mC / 1000.0, q16ToDouble(q16FromMilli(mC)));
+  }
+}
+
+// koszt jednego compute() – część ticku, którą zastąpił FixedPID. Na hoście (FPU) to tylko
+// proporcja; na ESP8266 double to soft-float, cykle samego kroku PID na
+// urządzeniu podaje /state (pid_cyc, pid_cyc_max) – porównanie: build z USE_FIXEDPID=0
+static void test_bench_compute() {
+  static const uint32_t N = 200000;
+  DoublePID ref(KP, KI, KD);
+  FixedPID  fx;
+  fx.setTunings(KP, KI, KD);
+  fx.setOutputLimits(0, 100 * Q16_ONE);
+  volatile double sinkD = 0;
+  volatile q16_t  sinkQ = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < N; i++) {
+    double o = 0;
+    ref.compute(i * 100, 500.0 + (i & 15) * 0.25, 505.0, o);
+    sinkD = sinkD + o;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < N; i++) {
+    q16_t o = 0;
+    fx.compute(i * 100, (500 << 16) + (q16_t)(i & 15) * (Q16_ONE / 4), 505 << 16, o);
+    sinkQ = sinkQ + o;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  const double nsD = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+  const double nsQ = std::chrono::duration<double, std::nano>(t2 - t1).count() / N;
+  char msg[96];
+  snprintf(msg, sizeof(msg), "compute(): double %.1f ns, Q16.16 %.1f ns (host)", nsD, nsQ);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE(nsD > 0 && nsQ > 0);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_q16_conversions);
+  RUN_TEST(test_open_loop_matches_double);
+  RUN_TEST(test_closed_loop_tracks_double);
+  RUN_TEST(test_scheduled_kd_updates_d_filter);
+  RUN_TEST(test_bench_compute);
+  return UNITY_END();
+}
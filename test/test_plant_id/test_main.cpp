@@ -0,0 +1,122 @@
+/***************************************************************************************
+ * FILE: test/test_plant_id/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 06:10 (Europe/Warsaw)
+ * PURPOSE: Identyfikacja FOPDT (RLS) – zbieżność na znanym obiekcie, wybór opóźnienia z banku,
+ *          czasy dojścia z modelu
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include "plant_id.h"
+#include "kiln_sim.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Fopdt { double K, tau, theta; };
+
+// piec ze znanym FOPDT, wypełnienie przełączane losowo 20..70 % co 10..40 min (pobudzenie
+// jak przy rampach i wytrzymaniach), pomiar z szumem MAX31855, tick 1 s
+static void identify(const Fopdt& p, double hours, PlantIdentifier& id, uint32_t seed) {
+  KilnPlant k(p.K, p.tau, p.theta, 20, 1.0);
+  k.settle(30);
+  TestNoise n(seed);
+  FAKE_MILLIS = 0;
+  id.reset();
+  double u = 30;
+  uint32_t nextMs = 600000;
+  for (uint32_t ms = 1000; ms <= (uint32_t)(hours * 3600000.0); ms += 1000) {
+    FAKE_MILLIS = ms;
+    if (ms >= nextMs) {
+      u = 20 + (n.uniform() + 0.5) * 50;
+      nextMs = ms + 600000 + (uint32_t)((n.uniform() + 0.5) * 1800000);
+    }
+    const double T = k.step(u);
+    id.sample(ms, max31855Read(T, n, 0.15), u);
+  }
+}
+
+// kilka obiektów z opóźnieniem z siatki banku: K ±10 %, tau ±15 %, theta dokładnie, Tamb ±10 °C
+static void test_converges_on_known_plant() {
+  static const Fopdt PLANTS[] = {
+    { 12, 1800, 160 },   // d = 16 kroków
+    {  8, 3600, 320 },   // wolny, duży piec
+    { 15,  900,  40 },   // mały piec testowy
+  };
+  char msg[128];
+  for (const Fopdt& p : PLANTS) {
+    PlantIdentifier id;
+    identify(p, 10, id, 5);
+    const PlantModel& m = id.model();
+    snprintf(msg, sizeof(msg), "K=%g tau=%g theta=%g -> K=%.2f tau=%.0f theta=%.0f amb=%.1f rms=%.3f",
+             p.K, p.tau, p.theta, m.K, m.tauSec, m.deadSec, m.ambC, id.rmsC());
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE_MESSAGE(id.valid(), msg);
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.10 * p.K, p.K, m.K, msg);
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.15 * p.tau, p.tau, m.tauSec, msg);
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(1.0, p.theta, m.deadSec, msg);
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(10.0, 20.0, m.ambC, msg);
+    TEST_ASSERT_TRUE_MESSAGE(id.rmsC() < 0.2, msg);
+  }
+}
+
+// opóźnienie spoza siatki (4 min, między 160 a 320 s) – najbliższy z banku, statyka dalej dobra
+static void test_delay_between_bank_entries() {
+  PlantIdentifier id;
+  identify({ 12, 1800, 240 }, 10, id, 6);
+  TEST_ASSERT_TRUE(id.valid());
+  TEST_ASSERT_TRUE(id.model().deadSec == 160 || id.model().deadSec == 320);
+  TEST_ASSERT_FLOAT_WITHIN(1.5, 12.0, id.model().K);
+}
+
+// pierwsze 10 min bez estymaty; dziura w pomiarze nie psuje modelu
+static void test_warmup_and_gaps() {
+  KilnPlant k(12, 1800, 160, 20, 1.0);
+  k.settle(30);
+  PlantIdentifier id;
+  FAKE_MILLIS = 0;
+  id.reset();
+  bool early = false;
+  for (uint32_t ms = 1000; ms <= 9UL * 60000UL; ms += 1000) {
+    FAKE_MILLIS = ms;
+    early |= id.sample(ms, k.step(ms < 120000 ? 30 : 60), ms < 120000 ? 30 : 60);
+  }
+  TEST_ASSERT_FALSE(early);
+  TEST_ASSERT_FALSE(id.valid());
+
+  identify({ 12, 1800, 160 }, 10, id, 7);
+  const PlantModel before = id.model();
+  for (uint32_t ms = 36000000UL; ms < 36000000UL + 120000UL; ms += 1000) {
+    FAKE_MILLIS = ms;
+    id.sample(ms, NAN, 50);
+  }
+  TEST_ASSERT_TRUE(id.valid());
+  TEST_ASSERT_FLOAT_WITHIN(0.01, before.K, id.model().K);
+}
+
+// czasy z modelu wobec tego samego obiektu symulowanego (bez opóźnienia – model go pomija)
+static void test_seconds_to_reach() {
+  PlantModel m;
+  m.K = 12; m.tauSec = 1800; m.deadSec = 0; m.ambC = 20;
+  KilnPlant k(12, 1800, 0, 20, 1.0);
+  k.settle(30);   // 380 °C
+  uint32_t s = 0;
+  while (k.T < 700 && s < 100000) { k.step(80); s++; }
+  TEST_ASSERT_FLOAT_WITHIN(5.0, (double)s, plantSecondsToReach(m, 380, 700, 80));
+  TEST_ASSERT_TRUE(isnan(plantSecondsToReach(m, 380, 1000, 80)));   // T∞ = 980 °C
+  TEST_ASSERT_TRUE(isnan(plantSecondsToReach(PlantModel(), 380, 700, 80)));
+
+  // rampa, za którą piec nadąża do końca (T∞ − rate·tau = 1170 °C > 900 °C) – czas samej rampy
+  TEST_ASSERT_FLOAT_WITHIN(1.0, 500 * 36.0, plantSecondsOnRamp(m, 400, 900, 100, 100));
+  // 300 °C/h przy 70 % (T∞ = 860 °C): nadąża do 710 °C, dalej wykładniczo do 800 °C
+  TEST_ASSERT_FLOAT_WITHIN(1.0, 310 * 12.0 + 1800 * log(150.0 / 60.0), plantSecondsOnRamp(m, 400, 800, 300, 70));
+  TEST_ASSERT_TRUE(isinf(plantSecondsOnRamp(m, 400, 1300, 100, 100)));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_converges_on_known_plant);
+  RUN_TEST(test_delay_between_bank_entries);
+  RUN_TEST(test_warmup_and_gaps);
+  RUN_TEST(test_seconds_to_reach);
+  return UNITY_END();
+}
@@ -0,0 +1,171 @@
+/***************************************************************************************
+ * FILE: test/test_safety/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 04:40 (Europe/Warsaw)
+ * PURPOSE: Nadzór bezpieczeństwa – OVERTEMP / BOARD / RELAY / NO_HEAT, wypał bez zadziałań,
+ *          czas zadziałania przy zablokowanej pętli
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include "safety.h"
+#include "kiln_sim.h"
+
+static const uint32_t FRAME_MS = 250;
+
+static int32_t milli(double c) { return (int32_t)lround(c * 1000.0); }
+
+void setUp() {}
+void tearDown() {}
+
+// pojedyncza zła ramka nie zatrzymuje wypału, druga z rzędu tak
+static void test_overtemp_needs_two_frames() {
+  SafetySupervisor s;
+  s.configure(SafetyLimits());
+  s.reset(0);
+  TEST_ASSERT_EQUAL_INT(TRIP_NONE, s.sample(0, true, 951000, 30000, true, false));
+  TEST_ASSERT_EQUAL_INT(TRIP_NONE, s.sample(250, true, 949000, 30000, true, false));
+  TEST_ASSERT_EQUAL_INT(TRIP_NONE, s.sample(500, true, 951000, 30000, true, false));
+  TEST_ASSERT_EQUAL_INT(TRIP_OVERTEMP, s.sample(750, true, 952000, 30000, true, false));
+  TEST_ASSERT_EQUAL_INT(952000, s.tripMilli());
+  TEST_ASSERT_EQUAL_INT(750, s.tripMs());
+  TEST_ASSERT_EQUAL_STRING("overtemp", safetyTripName(s.trip()));
+
+  // zatrzaśnięty do reset(), także gdy temperatura wróci
+  TEST_ASSERT_EQUAL_INT(TRIP_OVERTEMP, s.sample(1000, true, 500000, 30000, false, false));
+  s.reset(1250);
+  TEST_ASSERT_EQUAL_INT(TRIP_NONE, s.sample(1250, true, 500000, 30000, false, false));
+}
+
+// złącze zimne liczy się także przy błędzie termopary
+static void test_board_overheat() {
+  SafetySupervisor s;
+  s.configure(SafetyLimits());
+  s.reset(0);
+  SafetyTrip r = TRIP_NONE;
+  uint32_t t = 0;
+  for (; t < 10000 && r == TRIP_NONE; t += FRAME_MS) {
+    r = s.sample(t, false, 0, t >= 2000 ? 71000 : 40000, false, false);
+  }
+  TEST_ASSERT_EQUAL_INT(TRIP_BOARD, r);
+  TEST_ASSERT_EQUAL_INT(2250, s.tripMs());
+}
+
+// po RUN piec stygnie przy wyłączonych SSR, potem rośnie 60 °C/h – zgrzany przekaźnik
+static void test_relay_weld() {
+  SafetySupervisor s;
+  SafetyLimits lim;
+  lim.maxMilli = 1300000;
+  s.configure(lim);
+  s.reset(0);
+  TestNoise n(5);
+  double T = 1000;
+  SafetyTrip r = TRIP_NONE;
+  uint32_t t = 0;
+  for (; t < 4UL * 3600000UL && r == TRIP_NONE; t += FRAME_MS) {
+    T += (t < 3600000UL ? -150.0 : 60.0) * FRAME_MS / 3600000.0;
+    r = s.sample(t, true, milli(max31855Read(T, n, 0.15)), 30000, false, false);
+  }
+  TEST_ASSERT_EQUAL_INT(TRIP_RELAY, r);
+  TEST_ASSERT_TRUE(s.tripMs() > 3600000UL);
+  // 10 °C przy 60 °C/h to 10 min; z granicą okna najwyżej dwa okna 20 min
+  TEST_ASSERT_TRUE(s.tripMs() - 3600000UL < 40UL * 60000UL);
+}
+
+// pełna moc, a piec stoi (termopara wypadła z komory)
+static void test_no_heat() {
+  SafetySupervisor s;
+  SafetyLimits lim;
+  lim.noRiseMs = 20UL * 60000UL;
+  s.configure(lim);
+  s.reset(0);
+  TestNoise n(9);
+  SafetyTrip r = TRIP_NONE;
+  uint32_t t = 0;
+  for (; t < 2UL * 3600000UL && r == TRIP_NONE; t += FRAME_MS) {
+    r = s.sample(t, true, milli(max31855Read(25, n, 0.15)), 30000, (t / 1000) % 2, true);
+  }
+  TEST_ASSERT_EQUAL_INT(TRIP_NO_HEAT, r);
+  TEST_ASSERT_TRUE(s.tripMs() >= lim.noRiseMs && s.tripMs() <= lim.noRiseMs + FRAME_MS);
+}
+
+// wypał bez usterek: rampa 150 °C/h pełną mocą do 900, wytrzymanie w oknie, stygnięcie
+static void test_normal_firing_never_trips() {
+  SafetySupervisor s;
+  SafetyLimits lim;
+  lim.noRiseMs = 20UL * 60000UL;
+  s.configure(lim);
+  s.reset(0);
+  TestNoise n(2);
+  double T = 20;
+  SafetyTrip r = TRIP_NONE;
+  for (uint32_t t = 0; t < 30UL * 3600000UL && r == TRIP_NONE; t += FRAME_MS) {
+    bool full = T < 898, heat;
+    double cph;
+    if (t < 6UL * 3600000UL) {
+      cph  = full ? 150 : 0;
+      heat = full || (t / 2000) % 4 == 0;
+    } else {
+      cph  = -100 * (T - 20) / 900;
+      heat = full = false;
+    }
+    T += cph * FRAME_MS / 3600000.0;
+    if (T > 900 && t < 6UL * 3600000UL) T = 900;
+    r = s.sample(t, true, milli(max31855Read(T, n, 0.15)), 35000, heat, full);
+  }
+  TEST_ASSERT_EQUAL_STRING("none", safetyTripName(r));
+}
+
+// rozbiegany piec (zgrzany SSR, 600 °C/h) przy loop() blokowanym na 1..8 s (HTTP, flash).
+// Ramki z przerwania timer1 przychodzą co 250 ms niezależnie od pętli – zadziałanie najpóźniej
+// na drugiej ramce ponad progiem. Dla porównania stara ścieżka (Ticker / os_timer) dostaje
+// ramki tylko wtedy, gdy pętla oddaje sterowanie – opóźnienie rośnie z długością blokady.
+static void test_overtemp_latency_with_stalled_loop() {
+  TestNoise n(11);
+  uint32_t worstIsr = 0, worstTicker = 0;
+  for (int trial = 0; trial < 200; trial++) {
+    SafetySupervisor isr, tick;
+    isr.configure(SafetyLimits());
+    tick.configure(SafetyLimits());
+    isr.reset(0);
+    tick.reset(0);
+
+    // blokady pętli: [start, koniec) co kilka sekund, losowej długości
+    auto u01 = [&n]() { return n.uniform() + 0.5; };
+    uint32_t stallA = 0, stallB = 0, nextStall = 1000 + (uint32_t)(u01() * 4000);
+    double   T = 940 - u01() * 3;          // próg 950 °C za ~1..2 min
+    uint32_t crossMs = 0, tripIsr = 0, tripTicker = 0;
+    bool     crossed = false;
+    for (uint32_t t = 0; t < 600000 && !(tripIsr && tripTicker); t += FRAME_MS) {
+      if (t >= stallB && t >= nextStall) {
+        stallA    = t;
+        stallB    = t + 1000 + (uint32_t)(u01() * 7000);
+        nextStall = stallB + (uint32_t)(u01() * 5000);
+      }
+      T += 600.0 * FRAME_MS / 3600000.0;
+      int32_t m = milli(T);
+      if (!crossed && m > SafetyLimits().maxMilli) { crossed = true; crossMs = t; }
+      if (!tripIsr && isr.sample(t, true, m, 30000, false, false) != TRIP_NONE) tripIsr = t;
+      bool loopRuns = t < stallA || t >= stallB;
+      if (!tripTicker && loopRuns && tick.sample(t, true, m, 30000, false, false) != TRIP_NONE) tripTicker = t;
+    }
+    TEST_ASSERT_TRUE(crossed && tripIsr && tripTicker);
+    if (tripIsr - crossMs > worstIsr) worstIsr = tripIsr - crossMs;
+    if (tripTicker - crossMs > worstTicker) worstTicker = tripTicker - crossMs;
+  }
+  char msg[96];
+  snprintf(msg, sizeof(msg), "OVERTEMP latency: timer1 ISR %u ms, loop-bound Ticker %u ms (worst of 200)",
+           (unsigned)worstIsr, (unsigned)worstTicker);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE(worstIsr <= 2 * FRAME_MS);
+  TEST_ASSERT_TRUE(worstTicker > worstIsr);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_overtemp_needs_two_frames);
+  RUN_TEST(test_board_overheat);
+  RUN_TEST(test_relay_weld);
+  RUN_TEST(test_no_heat);
+  RUN_TEST(test_normal_firing_never_trips);
+  RUN_TEST(test_overtemp_latency_with_stalled_loop);
+  return UNITY_END();
+}
@@ -0,0 +1,137 @@
+/***************************************************************************************
+ * FILE: test/test_smith_predictor/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 05:30 (Europe/Warsaw)
+ * PURPOSE: Predyktor Smitha – przewidywanie pomiaru o theta naprzód, statyka przy błędzie modelu,
+ *          zamknięta pętla z PID przy długim opóźnieniu
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include <vector>
+#include "smith_predictor.h"
+#include "kiln_sim.h"
+
+static const double K = 12, TAU = 1800, THETA = 90, AMB = 20;
+
+static PlantModel model(double kMul, double tauMul, double thetaAdd) {
+  PlantModel m;
+  m.K       = (float)(K * kMul);
+  m.tauSec  = (float)(TAU * tauMul);
+  m.deadSec = (float)(THETA + thetaAdd);
+  m.ambC    = (float)AMB;
+  return m;
+}
+
+// skok wypełnienia 40 → 60 % ze stanu ustalonego, tick 1 s; przebiegi pomiaru i korekty
+static void stepResponse(const PlantModel& m, std::vector<double>& meas, std::vector<double>& corr,
+                         long seconds) {
+  KilnPlant k(K, TAU, THETA, AMB, 1.0);
+  k.settle(40);
+  SmithPredictor sp;
+  FAKE_MILLIS = 0;
+  sp.configure(m);
+  sp.reset(q16FromDouble(40));
+  for (long s = 1; s <= seconds; s++) {
+    FAKE_MILLIS = (uint32_t)s * 1000UL;
+    const q16_t duty = q16FromDouble(60);
+    meas.push_back(k.step(60));
+    sp.update(FAKE_MILLIS, duty);
+    corr.push_back(q16ToDouble(sp.correction()));
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_disabled_without_model() {
+  SmithPredictor sp;
+  sp.configure(PlantModel());
+  TEST_ASSERT_FALSE(sp.active());
+  sp.configure(model(1, 1, -THETA + 0.5));   // theta krótsza niż krok
+  TEST_ASSERT_FALSE(sp.active());
+  TEST_ASSERT_EQUAL_INT(0, sp.correction());
+}
+
+// dokładny model: pomiar + korekta = pomiar za theta – opóźnienie znika z pętli
+static void test_predicts_measurement_theta_ahead() {
+  std::vector<double> meas, corr;
+  stepResponse(model(1, 1, 0), meas, corr, 3 * 3600);
+  const size_t th = (size_t)THETA;
+  double maxErr = 0;
+  for (size_t i = 0; i + th < meas.size(); i++) {
+    maxErr = fmax(maxErr, fabs(meas[i] + corr[i] - meas[i + th]));
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.25, 0.0, maxErr);   // przy skoku o 240 °C w stanie ustalonym
+
+  // pomiar jeszcze stoi, predykcja już rośnie – PID widzi skutek od razu, nie po theta
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, meas[(size_t)THETA / 2] - meas[0]);
+  TEST_ASSERT_TRUE(corr[(size_t)THETA / 2] > 3.0);
+}
+
+// błąd modelu wraca przez pomiar: w stanie ustalonym korekta → 0, statyka bez zmian
+static void test_correction_vanishes_with_model_error() {
+  std::vector<double> meas, corr;
+  stepResponse(model(1.15, 0.85, 20), meas, corr, 6 * 3600);
+  TEST_ASSERT_FLOAT_WITHIN(0.05, 0.0, corr.back());
+  TEST_ASSERT_FLOAT_WITHIN(0.5, AMB + K * 60, meas.back());
+}
+
+// zamknięta pętla: skok zadanej 500 → 700 °C na obiekcie z opóźnieniem 10 min (termopara
+// w osłonie, gruby mur); tick 1 s, wyjście 0..100 %. Nastawy PI wg SIMC (Skogestad):
+// Kc = tau/(K·(tauc + theta)), Ti = min(tau, 4·(tauc + theta)), tauc = 5 min. Bez predyktora
+// PI musi uwzględnić theta, z predyktorem – strojony jak obiekt bez opóźnienia
+struct LoopResult { double overshoot, settleSec; };
+
+static LoopResult closedLoop(bool smith, double thetaSec) {
+  KilnPlant k(K, TAU, thetaSec, AMB, 1.0);
+  const double sp0 = 500, sp1 = 700;
+  k.settle((sp0 - AMB) / K);
+
+  FixedPID pid;
+  pid.setSampleTime(1000);
+  const double tauc = 300, thetaTune = smith ? 0 : thetaSec;
+  const double kc = TAU / (K * (tauc + thetaTune)), ti = fmin(TAU, 4 * (tauc + thetaTune));
+  pid.setTunings(kc, kc / ti, 0);
+  pid.setOutputLimits(0, 100 * Q16_ONE);
+  SmithPredictor sp;
+  FAKE_MILLIS = 0;
+  sp.configure(model(1, 1, thetaSec - THETA));
+  const q16_t u0 = q16FromDouble((sp0 - AMB) / K);
+  sp.reset(u0);
+  pid.initialize(q16FromDouble(sp0), q16FromDouble(sp0), u0);
+
+  LoopResult r = { 0, 0 };
+  q16_t u = u0;
+  double meas = k.T;
+  for (long s = 1; s <= 12L * 3600L; s++) {
+    FAKE_MILLIS = (uint32_t)s * 1000UL;
+    const q16_t in = q16FromDouble(meas) + (smith ? sp.correction() : 0);
+    pid.compute(FAKE_MILLIS, in, q16FromDouble(sp1), u);
+    meas = k.step(q16ToDouble(u));
+    sp.update(FAKE_MILLIS, u);
+    r.overshoot = fmax(r.overshoot, meas - sp1);
+    if (fabs(meas - sp1) > 2.0) r.settleSec = (double)s;   // ostatnie wyjście z pasma ±2 °C
+  }
+  return r;
+}
+
+static void test_closed_loop_beats_plain_pid() {
+  const double thetaSec = 600;
+  const LoopResult pi = closedLoop(false, thetaSec);
+  const LoopResult sm = closedLoop(true, thetaSec);
+  char msg[128];
+  snprintf(msg, sizeof(msg), "theta=%.0fs: PI overshoot %.1f C settle %.0f min, Smith %.1f C %.0f min",
+           thetaSec, pi.overshoot, pi.settleSec / 60, sm.overshoot, sm.settleSec / 60);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE(sm.overshoot < pi.overshoot);
+  TEST_ASSERT_TRUE(sm.settleSec < pi.settleSec);
+  TEST_ASSERT_TRUE(sm.settleSec < 12 * 3600 - 1);   // w ogóle się ustala
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_disabled_without_model);
+  RUN_TEST(test_predicts_measurement_theta_ahead);
+  RUN_TEST(test_correction_vanishes_with_model_error);
+  RUN_TEST(test_closed_loop_beats_plain_pid);
+  return UNITY_END();
+}
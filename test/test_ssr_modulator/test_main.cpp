@@ -0,0 +1,154 @@
+/***************************************************************************************
+ * FILE: test/test_ssr_modulator/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 05:40 (Europe/Warsaw)
+ * PURPOSE: Modulator SSR – średnie wypełnienie WINDOW / SIGMA_DELTA / BURST, sekcje grzałek,
+ *          tętnienia węzła cieplnego i liczba przełączeń
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include "ssr_modulator.h"
+#include "kiln_sim.h"
+
+struct ModStats {
+  double avgPct;      // średnie wypełnienie sekcji [%]
+  long   switches;    // przełączenia wszystkich sekcji na godzinę
+  uint8_t maxOn;      // najwięcej sekcji naraz
+};
+
+// 1 h z loop() co 1..8 ms (jitter jak na ESP z WiFi), czas włączenia liczony per sekcja
+static ModStats runMod(uint8_t mod, uint32_t periodMs, uint8_t banks, double dutyPct) {
+  SsrModulator s;
+  s.configure(mod, periodMs, 50, banks);
+  s.reset(0);
+  TestNoise n(1);
+  ModStats st = { 0, 0, 0 };
+  uint8_t last = 0;
+  double onMs = 0;
+  uint32_t now = 0;
+  while (now < 3600000UL) {
+    const uint32_t dt = 1 + (uint32_t)((n.uniform() + 0.5) * 7.999);
+    const uint8_t m = s.step(now, q16FromDouble(dutyPct));
+    uint8_t on = 0;
+    for (uint8_t b = 0; b < banks; b++) {
+      if (m & (1u << b)) { on++; onMs += dt; }
+      if ((m ^ last) & (1u << b)) st.switches++;
+    }
+    if (on > st.maxOn) st.maxOn = on;
+    last = m;
+    now += dt;
+  }
+  st.avgPct = onMs / banks / now * 100.0;
+  return st;
+}
+
+static const uint8_t MODS[] = { SSR_MOD_WINDOW, SSR_MOD_SIGMA_DELTA, SSR_MOD_BURST };
+static const double DUTIES[] = { 5, 37, 50, 73, 96 };
+
+void setUp() {}
+void tearDown() {}
+
+static void test_average_duty() {
+  for (uint8_t mod : MODS) {
+    for (uint8_t banks = 1; banks <= SSR_MOD_BANKS_MAX; banks += 2) {
+      for (double d : DUTIES) {
+        const ModStats st = runMod(mod, 2000, banks, d);
+        char msg[64];
+        snprintf(msg, sizeof(msg), "%s banks=%u duty=%g avg=%.3f", ssrModName(mod), banks, d, st.avgPct);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.5, d, st.avgPct, msg);
+        // naraz najwyżej ⌈N·duty⌉ sekcji – na tym opiera się limit mocy chwilowej
+        TEST_ASSERT_TRUE_MESSAGE(st.maxOn <= (uint8_t)ceil(banks * d / 100.0), msg);
+      }
+    }
+  }
+}
+
+static void test_extremes() {
+  for (uint8_t mod : MODS) {
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, runMod(mod, 2000, 3, 0).avgPct);
+    const ModStats full = runMod(mod, 2000, 3, 100);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 100.0, full.avgPct);
+    TEST_ASSERT_TRUE(full.switches <= 3);   // tylko pierwsze włączenie
+  }
+}
+
+// kompromis z nagłówka: SIGMA_DELTA przełącza najczęściej, BURST nie częściej niż WINDOW
+static void test_switching_tradeoff() {
+  const long w = runMod(SSR_MOD_WINDOW, 2000, 1, 37).switches;
+  const long s = runMod(SSR_MOD_SIGMA_DELTA, 2000, 1, 37).switches;
+  const long b = runMod(SSR_MOD_BURST, 2000, 1, 37).switches;
+  TEST_ASSERT_TRUE(s > 10 * w);
+  TEST_ASSERT_TRUE(b <= w + 2);
+  TEST_ASSERT_TRUE(w <= 2 * 3600 / 2 + 2);   // 2 przełączenia na okno 2 s
+}
+
+// węzeł cieplny przy grzałce (spirala + półka, tau 20 s): dT/dt = (RISE·on − T)/tau, T – nad
+// temperaturą komory. 10 min, z ostatnich 5 min tętnienia międzyszczytowe i przełączenia na h
+struct NodeStats { double ripple, meanC; long switchesPerH; };
+
+static NodeStats runNode(uint8_t mod, uint32_t periodMs, double dutyPct) {
+  static const double TAU_S = 20, RISE_C = 300;   // RISE_C – przyrost węzła przy 100 %
+  SsrModulator s;
+  s.configure(mod, periodMs, 50, 1);
+  s.reset(0);
+  TestNoise n(9);
+  double T = RISE_C * dutyPct / 100.0, lo = 1e9, hi = -1e9, sum = 0;
+  long sw = 0;
+  uint8_t last = 0;
+  uint32_t now = 0, measMs = 0;
+  while (now < 600000UL) {
+    const uint32_t dt = 1 + (uint32_t)((n.uniform() + 0.5) * 7.999);
+    const uint8_t m = s.step(now, q16FromDouble(dutyPct));
+    T += dt / 1000.0 / TAU_S * ((m ? RISE_C : 0.0) - T);
+    if (now >= 300000UL) {
+      lo = fmin(lo, T);
+      hi = fmax(hi, T);
+      sum += T * dt;
+      measMs += dt;
+      if (m != last) sw++;
+    }
+    last = m;
+    now += dt;
+  }
+  NodeStats st = { hi - lo, sum / measMs, sw * 3600000L / (long)measMs };
+  return st;
+}
+
+// tętnienia vs przełączenia: SIGMA_DELTA prawie płasko, ale najwięcej przełączeń; WINDOW
+// i BURST – ograniczenie z PWM na obiekcie 1. rzędu, Δ ≤ RISE·period/(4·tau) (przy 50 %),
+// rośnie z oknem; BURST przełącza najrzadziej (reszta przechodzi do następnego okna)
+static void test_thermal_node_ripple() {
+  const double duty = 50, boundPerMs = 300.0 / (4 * 20000.0);
+  char msg[160];
+  const NodeStats w2  = runNode(SSR_MOD_WINDOW, 2000, duty);
+  const NodeStats w10 = runNode(SSR_MOD_WINDOW, 10000, duty);
+  const NodeStats sd  = runNode(SSR_MOD_SIGMA_DELTA, 2000, duty);
+  const NodeStats b2  = runNode(SSR_MOD_BURST, 2000, duty);
+  const NodeStats* all[] = { &w2, &w10, &sd, &b2 };
+  const char* names[] = { "window 2s", "window 10s", "sigma-delta", "burst 2s" };
+  for (uint8_t i = 0; i < 4; i++) {
+    snprintf(msg, sizeof(msg), "%-11s ripple %6.2f C  mean %6.1f C  switches %6ld/h",
+             names[i], all[i]->ripple, all[i]->meanC, all[i]->switchesPerH);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(1.5, 150.0, all[i]->meanC, msg);   // średnia = duty·RISE
+  }
+
+  TEST_ASSERT_TRUE(sd.ripple < 0.5);
+  TEST_ASSERT_TRUE(w2.ripple <= 1.1 * boundPerMs * 2000);
+  TEST_ASSERT_TRUE(w10.ripple <= 1.1 * boundPerMs * 10000);
+  TEST_ASSERT_TRUE(b2.ripple <= 1.1 * boundPerMs * 2000);
+  TEST_ASSERT_TRUE(w10.ripple > 3 * w2.ripple);
+  TEST_ASSERT_TRUE(sd.ripple * 10 < w2.ripple);
+
+  TEST_ASSERT_TRUE(sd.switchesPerH > 10 * w2.switchesPerH);
+  TEST_ASSERT_TRUE(w2.switchesPerH >= b2.switchesPerH);
+  TEST_ASSERT_TRUE(w2.switchesPerH > w10.switchesPerH);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_average_duty);
+  RUN_TEST(test_extremes);
+  RUN_TEST(test_switching_tradeoff);
+  RUN_TEST(test_thermal_node_ripple);
+  return UNITY_END();
+}
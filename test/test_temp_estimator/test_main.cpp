@@ -0,0 +1,104 @@
+/***************************************************************************************
+ * FILE: test/test_temp_estimator/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 04:00 (Europe/Warsaw)
+ * PURPOSE: Estymator Kalmana – nachylenie z zaszumionej rampy, opóźnienie reakcji na zmianę rampy
+ ***************************************************************************************/
+#include <unity.h>
+#include <vector>
+#include "temp_estimator.h"
+#include "kiln_sim.h"
+
+static const uint32_t TS_MS = 250;
+
+// rampa rate1 °C/h do tSwitch, potem rate2 °C/h; ramki MAX31855 co TS_MS, bez modelu
+struct RampRun {
+  std::vector<double> truth, est, diff60;   // nachylenia [°C/h] w każdej ramce
+};
+
+static RampRun runRamp(double rate1, double rate2, double tSwitchSec, double totalSec) {
+  TempEstimator kf;
+  kf.begin(TS_MS);
+  kf.configure(PlantModel());
+  TestNoise n(11);
+  RampRun r;
+  std::vector<double> meas;
+  const double ts = TS_MS / 1000.0;
+  const size_t lag60 = (size_t)(60.0 / ts);
+  for (long k = 0; k * ts < totalSec; k++) {
+    const double t = k * ts;
+    const double T = t < tSwitchSec ? 200 + rate1 * t / 3600
+                                    : 200 + rate1 * tSwitchSec / 3600 + rate2 * (t - tSwitchSec) / 3600;
+    const double m = max31855Read(T, n, 0.15);
+    meas.push_back(m);
+    kf.update(q16FromDouble(m), 0);
+    r.truth.push_back(t < tSwitchSec ? rate1 : rate2);
+    r.est.push_back(q16ToDouble(kf.rate()) * 3600.0);
+    const size_t N = meas.size();
+    r.diff60.push_back(N > lag60 ? (meas[N - 1] - meas[N - 1 - lag60]) * 60.0 : 0.0);
+  }
+  return r;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// stała rampa 150 °C/h: estymata bez biasu i gładsza niż różnica z 60 s
+static void test_rate_on_noisy_ramp() {
+  const RampRun r = runRamp(150, 150, 1e9, 2 * 3600);
+  const size_t from = r.est.size() / 4;   // po dojściu filtru
+  double sum = 0, seK = 0, seD = 0;
+  for (size_t i = from; i < r.est.size(); i++) {
+    sum += r.est[i] - r.truth[i];
+    seK += pow(r.est[i] - r.truth[i], 2);
+    seD += pow(r.diff60[i] - r.truth[i], 2);
+  }
+  const double n = (double)(r.est.size() - from);
+  TEST_ASSERT_FLOAT_WITHIN(2.0, 0.0, sum / n);
+  TEST_ASSERT_TRUE(sqrt(seK / n) < 5.0);
+  TEST_ASSERT_TRUE(sqrt(seK / n) < 0.5 * sqrt(seD / n));
+}
+
+// zmiana rampy 100 → 300 °C/h: połowa zmiany w estymacie szybciej niż w minutę
+static void test_rate_change_latency() {
+  const double tSw = 3600;
+  const RampRun r = runRamp(100, 300, tSw, tSw + 900);
+  const size_t iSw = (size_t)(tSw * 1000 / TS_MS);
+  size_t i = iSw;
+  // średnia krocząca 5 s – pojedyncze ramki z szumem nie przecinają progu przypadkiem
+  double avg = 0;
+  for (; i < r.est.size(); i++) {
+    avg += (r.est[i] - avg) * TS_MS / 5000.0;
+    if (i > iSw + 20 && avg > 200) break;
+  }
+  TEST_ASSERT_TRUE(i < r.est.size());
+  const double latencySec = (i - iSw) * TS_MS / 1000.0;
+  TEST_ASSERT_TRUE(latencySec < 60.0);
+  // i bez przestrzelenia o więcej niż 1/4 skoku
+  double peak = 0;
+  for (size_t j = iSw; j < r.est.size(); j++) peak = fmax(peak, r.est[j]);
+  TEST_ASSERT_TRUE(peak < 350.0);
+}
+
+// model z wejściem grzałek: w stanie ustalonym nachylenie ≈ 0 mimo dużego udziału włączenia
+static void test_model_steady_state() {
+  PlantModel m;
+  m.K = 12; m.tauSec = 1800; m.ambC = 20;
+  TempEstimator kf;
+  kf.begin(TS_MS);
+  kf.configure(m);
+  TestNoise n(3);
+  const double T = 20 + 12 * 50;   // 50 % w stanie ustalonym
+  for (long k = 0; k < 4L * 3600 * 4; k++) {
+    kf.update(q16FromDouble(max31855Read(T, n, 0.15)), q16FromDouble(0.5));
+  }
+  TEST_ASSERT_FLOAT_WITHIN(5.0, 0.0, q16ToDouble(kf.rate()) * 3600.0);
+  TEST_ASSERT_FLOAT_WITHIN(0.5, T, q16ToDouble(kf.temp()));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rate_on_noisy_ramp);
+  RUN_TEST(test_rate_change_latency);
+  RUN_TEST(test_model_steady_state);
+  return UNITY_END();
+}
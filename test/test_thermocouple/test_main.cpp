@@ -0,0 +1,121 @@
+/***************************************************************************************
+ * FILE: test/test_thermocouple/test_main.cpp
+ * LAST MODIFIED: 2026-10-20 06:20 (Europe/Warsaw)
+ * PURPOSE: Termopara typu K – punkty tabeli NIST ITS-90 przez model MAX31855, rozbiór ramki
+ *          i bity błędów (maska 0x00010007)
+ ***************************************************************************************/
+#include <unity.h>
+#include <stdio.h>
+#include "thermocouple.h"
+
+// NIST ITS-90, typ K, złącze odniesienia 0 °C: E(T) [mV] z tabeli
+struct NistPoint { double tC, mV; };
+static const NistPoint NIST_K[] = {
+  { -100, -3.554 }, {    0,  0.000 }, {  100,  4.096 }, {  200,  8.138 },
+  {  300, 12.209 }, {  400, 16.397 }, {  500, 20.644 }, {  600, 24.905 },
+  {  700, 29.129 }, {  800, 33.275 }, {  900, 37.326 }, { 1000, 41.276 },
+  { 1100, 45.119 }, { 1200, 48.838 }, { 1300, 52.410 },
+};
+static const double NIST_K_25C_MV = 1.000;   // E(25 °C) – złącze zimne w obudowie
+
+// MAX31855: T = V / 41.276 µV/°C + T_CJ, kwant 0.25 °C; złącze zimne co 1/16 °C
+static int16_t maxCounts(double vMv, double cjC) {
+  return (int16_t)lround((vMv * 1000.0 / 41.276 + cjC) * 4.0);
+}
+
+// ramka 32-bit: D31..D18 termopara, D16 fault, D15..D4 złącze zimne, D2..D0 SCV/SCG/OC
+static uint32_t frame(int16_t tc, int16_t cj, uint32_t faultBits = 0) {
+  return ((uint32_t)(tc & 0x3FFF) << 18) | ((uint32_t)(cj & 0xFFF) << 4) | faultBits;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// każdy punkt tabeli przy złączu zimnym 0 i 25 °C: po linearyzacji ±0.2 °C (kwant układu
+// 0.25 °C + błąd wielomianu odwrotnego NIST ≤ 0.06 °C); bez korekty – do kilkunastu °C
+static void test_nist_table_points() {
+  char msg[96];
+  double worstRaw = 0;
+  for (const NistPoint& p : NIST_K) {
+    for (int cjC = 0; cjC <= 25; cjC += 25) {
+      const double  v  = p.mV - (cjC ? NIST_K_25C_MV : 0.0);
+      const int16_t tc = maxCounts(v, cjC);
+      const double  t  = tcLinearizeCounts(tc, (int16_t)(cjC * 16)) / 1000.0;
+      snprintf(msg, sizeof(msg), "T=%g cj=%d: raw %.2f -> %.3f", p.tC, cjC, tc / 4.0, t);
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.2, p.tC, t, msg);
+      if (fabs(tc / 4.0 - p.tC) > worstRaw) worstRaw = fabs(tc / 4.0 - p.tC);
+    }
+  }
+  snprintf(msg, sizeof(msg), "worst uncorrected MAX31855 error over -100..1300 C: %.1f C", worstRaw);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE(worstRaw > 10);   // bez linearyzacji wyraźnie poza tolerancją
+}
+
+// złącze zimne w całym zakresie tabeli (-40..125 °C) – wynik ciągły i ściśle rosnący w tc;
+// odczyt układu -120..1300 °C: napięcie całkowite w zakresie tabeli odwrotnej (poza nim – obcięte)
+static void test_cold_junction_range() {
+  for (int cj16 = -40 * 16; cj16 <= 125 * 16; cj16 += 8) {
+    int32_t prev = INT32_MIN;
+    for (int16_t tc = -120 * 4; tc <= 1300 * 4; tc += 7) {
+      const int32_t t = tcLinearizeCounts(tc, (int16_t)cj16);
+      TEST_ASSERT_TRUE(t > prev);
+      if (prev != INT32_MIN) TEST_ASSERT_TRUE(t - prev < 3500);   // 1.75 °C × 41.3/22 µV/°C (-170 °C)
+      prev = t;
+    }
+  }
+}
+
+// rozbiór ramki: znak obu pól, bity zarezerwowane (D17, D3) nie są błędem
+static void test_decode_frame() {
+  int16_t tc = 0, cj = 0;
+  TEST_ASSERT_TRUE(tcDecodeFrame(frame(4000, 400), tc, cj));   // 1000 °C, 25 °C
+  TEST_ASSERT_EQUAL_INT(4000, tc);
+  TEST_ASSERT_EQUAL_INT(400, cj);
+
+  TEST_ASSERT_TRUE(tcDecodeFrame(frame(-400, -160), tc, cj));  // -100 °C, -10 °C
+  TEST_ASSERT_EQUAL_INT(-400, tc);
+  TEST_ASSERT_EQUAL_INT(-160, cj);
+
+  TEST_ASSERT_TRUE(tcDecodeFrame(frame(8191, 2047), tc, cj));  // skraje pól
+  TEST_ASSERT_EQUAL_INT(8191, tc);
+  TEST_ASSERT_EQUAL_INT(2047, cj);
+  TEST_ASSERT_TRUE(tcDecodeFrame(frame(-8192, -2048), tc, cj));
+  TEST_ASSERT_EQUAL_INT(-8192, tc);
+  TEST_ASSERT_EQUAL_INT(-2048, cj);
+
+  TEST_ASSERT_TRUE(tcDecodeFrame(frame(4000, 400) | (1UL << 17) | (1UL << 3), tc, cj));
+  TEST_ASSERT_EQUAL_INT(4000, tc);
+  TEST_ASSERT_EQUAL_INT(400, cj);
+}
+
+// błąd: D16 (fault) albo którykolwiek z OC / SCG / SCV – złącze zimne dalej poprawne
+static void test_fault_frames() {
+  static const uint32_t FAULTS[] = {
+    1UL << 16,                 // sam fault
+    (1UL << 16) | 0x1,         // OC – termopara rozwarta
+    (1UL << 16) | 0x2,         // SCG – zwarcie do masy
+    (1UL << 16) | 0x4,         // SCV – zwarcie do zasilania
+    0x1, 0x2, 0x4,             // bit błędu bez D16 (zakłócona ramka) – też odrzucamy
+    (1UL << 16) | 0x7,
+  };
+  char msg[48];
+  for (uint32_t f : FAULTS) {
+    int16_t tc = 0, cj = 0;
+    snprintf(msg, sizeof(msg), "fault bits 0x%08lx", (unsigned long)f);
+    TEST_ASSERT_FALSE_MESSAGE(tcDecodeFrame(frame(4000, 432, f), tc, cj), msg);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(432, cj, msg);
+  }
+  // typowa ramka rozwartej termopary: pole tc = 0x1FFF… wg układu, byle fault był zgłoszony
+  int16_t tc = 0, cj = 0;
+  TEST_ASSERT_FALSE(tcDecodeFrame(0x7FFC0000UL | (400UL << 4) | (1UL << 16) | 0x1, tc, cj));
+  TEST_ASSERT_EQUAL_INT(400, cj);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nist_table_points);
+  RUN_TEST(test_cold_junction_range);
+  RUN_TEST(test_decode_frame);
+  RUN_TEST(test_fault_frames);
+  return UNITY_END();
+}